@@ -0,0 +1,155 @@
+#include "AnalyzerComponent.h"
+
+AnalyzerComponent::AnalyzerComponent(VisualizationFeed& visualizationFeed)
+    : feed(visualizationFeed),
+      history(kFftSize, 0.0f),
+      incoming(VisualizationFeed::kCapacity),
+      window(kFftSize),
+      twiddles(kFftSize / 2),
+      bitReversedIndices(kFftSize),
+      fftData(kFftSize),
+      spectrumDecibels(kFftSize / 2, kMinDecibels) {
+  // Hann window
+  for (int i = 0; i < kFftSize; i++) {
+    window[i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * i /
+                                       (kFftSize - 1));
+  }
+
+  for (int i = 0; i < kFftSize / 2; i++) {
+    twiddles[i] = std::polar(
+        1.0f, -juce::MathConstants<float>::twoPi * i / (float)kFftSize);
+  }
+
+  for (int i = 0; i < kFftSize; i++) {
+    int reversed = 0;
+    for (int bit = 0; bit < kFftOrder; bit++) {
+      reversed |= ((i >> bit) & 1) << (kFftOrder - 1 - bit);
+    }
+    bitReversedIndices[i] = reversed;
+  }
+
+  setOpaque(true);
+  startTimerHz(kFramesPerSecond);
+}
+
+AnalyzerComponent::~AnalyzerComponent() { stopTimer(); }
+
+void AnalyzerComponent::clear() {
+  std::fill(history.begin(), history.end(), 0.0f);
+  std::fill(spectrumDecibels.begin(), spectrumDecibels.end(), kMinDecibels);
+  historyPosition = 0;
+  repaint();
+}
+
+void AnalyzerComponent::timerCallback() {
+  int numSamples = feed.popSamples(incoming.data(), (int)incoming.size());
+  if (numSamples == 0) return;
+
+  // Only the newest kFftSize samples are ever shown
+  int firstSample = juce::jmax(0, numSamples - kFftSize);
+  for (int i = firstSample; i < numSamples; i++) {
+    history[historyPosition] = incoming[i];
+    historyPosition = (historyPosition + 1) % kFftSize;
+  }
+
+  updateSpectrum();
+  repaint();
+}
+
+void AnalyzerComponent::updateSpectrum() {
+  for (int i = 0; i < kFftSize; i++) {
+    float sample = history[(historyPosition + i) % kFftSize];
+    fftData[bitReversedIndices[i]] = {sample * window[i], 0.0f};
+  }
+  performFft(fftData);
+
+  // Let peaks fall slowly rather than flicker between frames
+  for (int bin = 0; bin < kFftSize / 2; bin++) {
+    float magnitude = std::abs(fftData[bin]) * 4.0f / kFftSize;
+    float decibels = juce::jmax(
+        kMinDecibels, juce::Decibels::gainToDecibels(magnitude, kMinDecibels));
+    float decayed = kMinDecibels + (spectrumDecibels[bin] - kMinDecibels) *
+                                       kSpectrumDecay;
+    spectrumDecibels[bin] = juce::jmax(decibels, decayed);
+  }
+}
+
+void AnalyzerComponent::performFft(
+    std::vector<std::complex<float>>& data) const {
+  // Expects its input in bit-reversed order
+  for (int size = 2; size <= kFftSize; size *= 2) {
+    int halfSize = size / 2;
+    int twiddleStep = kFftSize / size;
+    for (int start = 0; start < kFftSize; start += size) {
+      for (int i = 0; i < halfSize; i++) {
+        auto odd = twiddles[i * twiddleStep] * data[start + i + halfSize];
+        auto even = data[start + i];
+        data[start + i] = even + odd;
+        data[start + i + halfSize] = even - odd;
+      }
+    }
+  }
+}
+
+void AnalyzerComponent::paint(juce::Graphics& g) {
+  g.fillAll(juce::Colours::black);
+
+  auto bounds = getLocalBounds().toFloat().reduced(4.0f);
+  auto scopeArea = bounds.removeFromLeft(bounds.getWidth() / 2).reduced(4.0f);
+  drawScope(g, scopeArea);
+  drawSpectrum(g, bounds.reduced(4.0f));
+}
+
+void AnalyzerComponent::drawScope(juce::Graphics& g,
+                                  juce::Rectangle<float> area) const {
+  g.setColour(juce::Colours::darkgrey);
+  g.drawRect(area);
+
+  // Show the newest quarter of the history so waveforms are readable
+  int numSamples = kFftSize / 4;
+  juce::Path path;
+  for (int i = 0; i < numSamples; i++) {
+    float sample =
+        history[(historyPosition + kFftSize - numSamples + i) % kFftSize];
+    float x = area.getX() + area.getWidth() * i / (numSamples - 1);
+    float y = area.getCentreY() -
+              area.getHeight() * 0.5f * juce::jlimit(-1.0f, 1.0f, sample);
+    if (i == 0) {
+      path.startNewSubPath(x, y);
+    } else {
+      path.lineTo(x, y);
+    }
+  }
+
+  g.setColour(juce::Colours::orange);
+  g.strokePath(path, juce::PathStrokeType(1.5f));
+}
+
+void AnalyzerComponent::drawSpectrum(juce::Graphics& g,
+                                     juce::Rectangle<float> area) const {
+  g.setColour(juce::Colours::darkgrey);
+  g.drawRect(area);
+
+  // Log-frequency axis from 20 Hz to Nyquist
+  const float kMinFreq = 20.0f;
+  float nyquist = (float)feed.getSampleRate() / 2.0f;
+  float binWidth = nyquist / (kFftSize / 2);
+
+  juce::Path path;
+  for (int x = 0; x < (int)area.getWidth(); x++) {
+    float proportion = x / area.getWidth();
+    float freq = kMinFreq * std::pow(nyquist / kMinFreq, proportion);
+    int bin = juce::jlimit(0, kFftSize / 2 - 1, (int)(freq / binWidth));
+
+    float level = juce::jmap(spectrumDecibels[bin], kMinDecibels, 0.0f,
+                             area.getBottom(), area.getY());
+    if (x == 0) {
+      path.startNewSubPath(area.getX(), level);
+    } else {
+      path.lineTo(area.getX() + x, level);
+    }
+  }
+
+  g.setColour(juce::Colours::lightblue);
+  g.strokePath(path, juce::PathStrokeType(1.5f));
+}
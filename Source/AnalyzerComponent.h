@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <complex>
+
+#include "VisualizationFeed.h"
+
+//==============================================================================
+/*
+    Draws an oscilloscope and a spectrum of the audio published to a
+    VisualizationFeed. All of the analysis happens here on the message thread,
+    at display rate.
+*/
+class AnalyzerComponent : public juce::Component, private juce::Timer {
+ public:
+  explicit AnalyzerComponent(VisualizationFeed& feed);
+  ~AnalyzerComponent() override;
+
+  void paint(juce::Graphics& g) override;
+
+  /** Clears the display, e.g. when playback starts */
+  void clear();
+
+ private:
+  static constexpr int kFftOrder = 11;
+  static constexpr int kFftSize = 1 << kFftOrder;
+  static constexpr int kFramesPerSecond = 30;
+  static constexpr float kMinDecibels = -100.0f;
+  static constexpr float kSpectrumDecay = 0.85f;
+
+  void timerCallback() override;
+  void updateSpectrum();
+  /** In-place iterative radix-2 FFT */
+  void performFft(std::vector<std::complex<float>>& data) const;
+  void drawScope(juce::Graphics& g, juce::Rectangle<float> area) const;
+  void drawSpectrum(juce::Graphics& g, juce::Rectangle<float> area) const;
+
+  VisualizationFeed& feed;
+
+  /** The most recent kFftSize samples, oldest first once wrapped */
+  std::vector<float> history;
+  int historyPosition = 0;
+  std::vector<float> incoming;
+
+  std::vector<float> window;
+  std::vector<std::complex<float>> twiddles;
+  std::vector<int> bitReversedIndices;
+  std::vector<std::complex<float>> fftData;
+  std::vector<float> spectrumDecibels;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyzerComponent)
+};
@@ -0,0 +1,130 @@
+#include "AudioSettings.h"
+
+namespace {
+const char* const kDeviceStateKey = "audioDeviceState";
+const char* const kProfileKey = "audioProfile";
+}  // namespace
+
+AudioSettings::AudioSettings(juce::AudioDeviceManager& audioDeviceManager)
+    : deviceManager(audioDeviceManager) {
+  // Kept next to the snapshot history
+  auto file =
+      juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+          .getChildFile("DataSonification")
+          .getChildFile("Settings.xml");
+  file.getParentDirectory().createDirectory();
+
+  juce::PropertiesFile::Options options;
+  options.applicationName = "DataSonification";
+  options.storageFormat = juce::PropertiesFile::storeAsXML;
+  properties = std::make_unique<juce::PropertiesFile>(file, options);
+
+  profile = ProfileId(juce::jlimit(
+      static_cast<int>(kDeviceDefault), static_cast<int>(kPowerSaving),
+      properties->getIntValue(kProfileKey, kDeviceDefault)));
+}
+
+AudioSettings::~AudioSettings() { deviceManager.removeChangeListener(this); }
+
+std::unique_ptr<juce::XmlElement> AudioSettings::getSavedDeviceState() const {
+  return properties->getXmlValue(kDeviceStateKey);
+}
+
+void AudioSettings::restore() {
+  // A saved state may still open an input, which would only add overhead
+  auto setup = deviceManager.getAudioDeviceSetup();
+  if (!setup.inputChannels.isZero() || setup.inputDeviceName.isNotEmpty()) {
+    setup.inputDeviceName = {};
+    setup.inputChannels.clear();
+    setup.useDefaultInputChannels = false;
+    deviceManager.setAudioDeviceSetup(setup, true);
+  }
+
+  // Otherwise keep whatever buffer size was last chosen for the device
+  if (profile != kDeviceDefault) applyProfile(profile);
+
+  deviceManager.addChangeListener(this);
+}
+
+juce::String AudioSettings::applyProfile(ProfileId newProfile) {
+  auto* device = deviceManager.getCurrentAudioDevice();
+  if (device == nullptr) return "No audio device is open";
+
+  // Restarting the device calls prepareToPlay() again with the new size
+  auto setup = deviceManager.getAudioDeviceSetup();
+  setup.bufferSize = chooseBufferSize(newProfile, *device);
+  auto error = deviceManager.setAudioDeviceSetup(setup, true);
+  if (error.isNotEmpty()) return error;
+
+  profile = newProfile;
+  properties->setValue(kProfileKey, static_cast<int>(profile));
+  return {};
+}
+
+juce::StringArray AudioSettings::getProfileNames() {
+  return {"Device default", "Low latency", "Power saving"};
+}
+
+juce::String AudioSettings::describeDevice() const {
+  auto* device = deviceManager.getCurrentAudioDevice();
+  if (device == nullptr) return "No audio device";
+
+  double sampleRate = device->getCurrentSampleRate();
+  int bufferSize = device->getCurrentBufferSizeSamples();
+  auto toMs = [sampleRate](int samples) {
+    return juce::String(samples * 1000.0 / sampleRate, 1) + " ms";
+  };
+  return device->getName() + ": " + juce::String(sampleRate, 0) + " Hz, " +
+         juce::String(bufferSize) + " samples (" + toMs(bufferSize) +
+         "), reported output latency " +
+         toMs(device->getOutputLatencyInSamples());
+}
+
+void AudioSettings::changeListenerCallback(juce::ChangeBroadcaster*) {
+  // Measuring opens an input for a moment, which shouldn't be remembered
+  if (!latencyMeter.isMeasuring()) save();
+}
+
+void AudioSettings::save() {
+  auto state = deviceManager.createStateXml();
+  if (state != nullptr) {
+    properties->setValue(kDeviceStateKey, state.get());
+  } else {
+    properties->removeValue(kDeviceStateKey);
+  }
+}
+
+int AudioSettings::chooseBufferSize(ProfileId profileId,
+                                    juce::AudioIODevice& device) {
+  auto sizes = device.getAvailableBufferSizes();
+  int bufferSize = device.getDefaultBufferSize();
+
+  switch (profileId) {
+    case kLowLatency: {
+      // The smallest size that isn't prone to dropouts
+      int smallest = std::numeric_limits<int>::max();
+      for (int size : sizes) {
+        if (size >= kMinLowLatencyBufferSize) {
+          smallest = juce::jmin(smallest, size);
+        }
+      }
+      if (smallest != std::numeric_limits<int>::max()) bufferSize = smallest;
+      break;
+    }
+    case kPowerSaving: {
+      // Fewer, larger callbacks let the CPU sleep for longer
+      int largest = 0;
+      for (int size : sizes) {
+        if (size <= kMaxPowerSavingBufferSize) {
+          largest = juce::jmax(largest, size);
+        }
+      }
+      if (largest > 0) bufferSize = largest;
+      break;
+    }
+    default:
+      break;
+  }
+
+  return bufferSize;
+}
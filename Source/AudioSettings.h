@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "LatencyMeter.h"
+
+//==============================================================================
+/*
+    Chooses, applies and remembers how the audio device is set up.
+
+    Only output channels are opened, since nothing is ever recorded apart from
+    latency measurements. Profiles pick the device's buffer size, while the
+    device itself and its sample rate are left as chosen. The device state and
+    profile are saved whenever they change and restored on the next launch.
+*/
+class AudioSettings : private juce::ChangeListener {
+ public:
+  enum ProfileId { kNoProfile, kDeviceDefault, kLowLatency, kPowerSaving };
+
+  static constexpr int kMinLowLatencyBufferSize = 64;
+  static constexpr int kMaxPowerSavingBufferSize = 2048;
+
+  explicit AudioSettings(juce::AudioDeviceManager& audioDeviceManager);
+  ~AudioSettings() override;
+
+  /**
+   * Returns the device state saved last time, or nullptr if there isn't one.
+   * Pass it to setAudioChannels() when opening the device.
+   */
+  std::unique_ptr<juce::XmlElement> getSavedDeviceState() const;
+
+  /**
+   * Applies the saved profile to the newly opened device, closing any input
+   * that the saved state opened, and starts saving changes
+   */
+  void restore();
+
+  /** Returns an error message, or an empty string on success */
+  juce::String applyProfile(ProfileId newProfile);
+  ProfileId getProfile() const noexcept { return profile; }
+  static juce::StringArray getProfileNames();
+
+  /** Describes the open device's rate, buffer size and reported latency */
+  juce::String describeDevice() const;
+
+  LatencyMeter& getLatencyMeter() noexcept { return latencyMeter; }
+  juce::AudioDeviceManager& getDeviceManager() noexcept {
+    return deviceManager;
+  }
+
+ private:
+  void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+  void save();
+  /** Picks the profile's buffer size from those the device supports */
+  static int chooseBufferSize(ProfileId profileId,
+                              juce::AudioIODevice& device);
+
+  juce::AudioDeviceManager& deviceManager;
+  std::unique_ptr<juce::PropertiesFile> properties;
+  ProfileId profile = kDeviceDefault;
+  LatencyMeter latencyMeter{deviceManager};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioSettings)
+};
@@ -0,0 +1,115 @@
+#include "AudioSettingsComponent.h"
+
+namespace {
+const int kRowHeight = 30;
+const int kPadding = 8;
+const int kLabelWidth = 65;
+}  // namespace
+
+AudioSettingsComponent::AudioSettingsComponent(AudioSettings& audioSettings)
+    : settings(audioSettings),
+      // Outputs only, since nothing is recorded
+      deviceSelector(audioSettings.getDeviceManager(), 0, 0, 1, 2, false,
+                     false, true, false) {
+  addAndMakeVisible(deviceSelector);
+
+  profileMenu.addItemList(AudioSettings::getProfileNames(),
+                          AudioSettings::kDeviceDefault);
+  profileMenu.setSelectedId(settings.getProfile(), juce::dontSendNotification);
+  profileMenu.addListener(this);
+  addAndMakeVisible(profileMenu);
+  addAndMakeVisible(profileLabel);
+  addAndMakeVisible(deviceLabel);
+
+  measureButton.addListener(this);
+  addAndMakeVisible(measureButton);
+  latencyLabel.setText("Loop an output back to an input, then measure",
+                       juce::dontSendNotification);
+  addAndMakeVisible(latencyLabel);
+
+  settings.getDeviceManager().addChangeListener(this);
+  deviceLabel.setText(settings.describeDevice(), juce::dontSendNotification);
+
+  setSize(520, 440);
+}
+
+AudioSettingsComponent::~AudioSettingsComponent() {
+  settings.getDeviceManager().removeChangeListener(this);
+}
+
+void AudioSettingsComponent::resized() {
+  auto bounds = getLocalBounds().reduced(kPadding);
+
+  auto latencyRow = bounds.removeFromBottom(kRowHeight);
+  measureButton.setBounds(latencyRow.removeFromLeft(118));
+  latencyRow.removeFromLeft(kPadding);
+  latencyLabel.setBounds(latencyRow);
+  bounds.removeFromBottom(kPadding);
+
+  deviceLabel.setBounds(bounds.removeFromBottom(kRowHeight));
+  auto profileRow = bounds.removeFromBottom(kRowHeight);
+  profileLabel.setBounds(profileRow.removeFromLeft(kLabelWidth));
+  profileMenu.setBounds(profileRow.removeFromLeft(180));
+  bounds.removeFromBottom(kPadding);
+
+  deviceSelector.setBounds(bounds);
+}
+
+void AudioSettingsComponent::comboBoxChanged(juce::ComboBox* menu) {
+  if (menu != &profileMenu) return;
+
+  auto error = settings.applyProfile(
+      AudioSettings::ProfileId(profileMenu.getSelectedId()));
+  if (error.isNotEmpty()) {
+    profileMenu.setSelectedId(settings.getProfile(),
+                              juce::dontSendNotification);
+    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+                                           "Audio settings", error);
+  }
+}
+
+void AudioSettingsComponent::buttonClicked(juce::Button* button) {
+  if (button != &measureButton) return;
+
+  measureButton.setEnabled(false);
+  latencyLabel.setText("Listening for the test signal...",
+                       juce::dontSendNotification);
+
+  // The dialog may be closed before the measurement finishes
+  juce::Component::SafePointer<AudioSettingsComponent> safeThis(this);
+  settings.getLatencyMeter().start(
+      [safeThis](const LatencyMeter::Result& result) {
+        if (safeThis != nullptr) safeThis->showLatency(result);
+      });
+}
+
+void AudioSettingsComponent::setPlaying(bool isPlaying) {
+  if (isPlaying == playing) return;
+  playing = isPlaying;
+
+  deviceSelector.setEnabled(!playing);
+  profileMenu.setEnabled(!playing);
+  measureButton.setEnabled(!playing &&
+                           !settings.getLatencyMeter().isMeasuring());
+}
+
+void AudioSettingsComponent::changeListenerCallback(juce::ChangeBroadcaster*) {
+  deviceLabel.setText(settings.describeDevice(), juce::dontSendNotification);
+}
+
+void AudioSettingsComponent::showLatency(const LatencyMeter::Result& result) {
+  measureButton.setEnabled(!playing);
+  if (!result.succeeded) {
+    latencyLabel.setText(result.error, juce::dontSendNotification);
+    return;
+  }
+
+  latencyLabel.setText(
+      "Round trip " + juce::String(result.roundTripMs, 1) + " ms, output " +
+          juce::String(result.outputMs, 1) + " ms (device reports " +
+          juce::String(result.reportedOutputMs, 1) + " ms)",
+      juce::dontSendNotification);
+  DBG("Measured latency: round trip "
+      << result.roundTripMs << " ms, reported input " << result.reportedInputMs
+      << " ms, reported output " << result.reportedOutputMs << " ms");
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "AudioSettings.h"
+
+//==============================================================================
+/*
+    Lets the user pick the output device and a latency profile, and measure
+    the device's real latency. Meant to be shown in a dialog window.
+*/
+class AudioSettingsComponent : public juce::Component,
+                               public juce::ComboBox::Listener,
+                               public juce::Button::Listener,
+                               private juce::ChangeListener {
+ public:
+  explicit AudioSettingsComponent(AudioSettings& audioSettings);
+  ~AudioSettingsComponent() override;
+
+  void resized() override;
+  void comboBoxChanged(juce::ComboBox* menu) override;
+  void buttonClicked(juce::Button* button) override;
+
+  /**
+   * Locks the device, profile and measurement controls while the app is
+   * playing, since restarting the device changes the sample rate and buffer
+   * size under the notes being played, and measuring plays a noise burst
+   */
+  void setPlaying(bool isPlaying);
+
+ private:
+  void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+  void showLatency(const LatencyMeter::Result& result);
+
+  AudioSettings& settings;
+
+  juce::AudioDeviceSelectorComponent deviceSelector;
+
+  juce::ComboBox profileMenu;
+  juce::Label profileLabel{"profileLabel", "Profile: "};
+  juce::Label deviceLabel{"deviceLabel", ""};
+
+  juce::TextButton measureButton{"Measure latency"};
+  juce::Label latencyLabel{"latencyLabel", ""};
+
+  bool playing = false;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioSettingsComponent)
+};
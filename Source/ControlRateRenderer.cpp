@@ -0,0 +1,154 @@
+#include "ControlRateRenderer.h"
+
+namespace {
+float pitchToIncrement(double pitch, double sampleRate) {
+  return (float)(440.0 * std::exp2((pitch - 69.0) / 12.0) / sampleRate);
+}
+}  // namespace
+
+void ControlRateRenderer::prepare(double newSampleRate,
+                                  int newControlInterval) {
+  sampleRate = newSampleRate;
+  controlInterval = juce::jmax(1, newControlInterval);
+  incrementRamp.resize((size_t)controlInterval);
+  amplitudeRamp.resize((size_t)controlInterval);
+  phases.resize((size_t)controlInterval);
+
+  rampSteps.resize((size_t)controlInterval);
+  for (int i = 0; i < controlInterval; i++) rampSteps[i] = (float)(i + 1);
+
+  sineTable.resize(kSineTableSize + 1);
+  for (int i = 0; i <= kSineTableSize; i++) {
+    sineTable[i] = (float)std::sin(juce::MathConstants<double>::twoPi * i /
+                                   kSineTableSize);
+  }
+}
+
+void ControlRateRenderer::start(const double* newPitches, int newNumPoints,
+                                int newSamplesPerPoint) noexcept {
+  pitches = newPitches;
+  numPoints = newNumPoints;
+  samplesPerPoint = juce::jmax(1, newSamplesPerPoint);
+  samplePosition = 0;
+  isFadingOut = false;
+  hasFinished = numPoints <= 0;
+
+  // Fade in from silence at the first pitch
+  phase = 0.0;
+  currentAmplitude = 0.0f;
+  if (!hasFinished) currentIncrement = pitchToIncrement(pitches[0], sampleRate);
+}
+
+bool ControlRateRenderer::render(float* output, int numSamples,
+                                 Waveform waveform) noexcept {
+  int numRendered = 0;
+  while (numRendered < numSamples && !hasFinished) {
+    int blockLength = prepareControlBlock(numSamples - numRendered);
+    renderWaveform(output + numRendered, blockLength, waveform);
+    numRendered += blockLength;
+  }
+
+  if (numRendered < numSamples) {
+    juce::FloatVectorOperations::clear(output + numRendered,
+                                       numSamples - numRendered);
+  }
+  return !hasFinished;
+}
+
+int ControlRateRenderer::getCurrentPoint() const noexcept {
+  if (numPoints <= 0) return 0;
+  return (int)juce::jmin((juce::int64)numPoints - 1,
+                         samplePosition / samplesPerPoint);
+}
+
+int ControlRateRenderer::prepareControlBlock(int maxSamples) noexcept {
+  int blockLength = juce::jmin(maxSamples, controlInterval);
+
+  // Find where pitch and amplitude should be by the end of this block
+  float endIncrement = currentIncrement;
+  float endAmplitude = 0.0f;
+  if (!isFadingOut) {
+    double position = (double)(samplePosition + blockLength) / samplesPerPoint;
+    int point = (int)position;
+    double pitch = pitches[numPoints - 1];
+    if (point + 1 < numPoints) {
+      double fraction = position - point;
+      pitch = pitches[point] + fraction * (pitches[point + 1] - pitches[point]);
+    }
+    endIncrement = pitchToIncrement(pitch, sampleRate);
+    endAmplitude = targetAmplitude;
+  }
+
+  // Change level by at most full scale per control interval, so fading in
+  // and out never clicks, however the output is split into blocks
+  float maxChange = (float)blockLength / (float)controlInterval;
+  endAmplitude = juce::jlimit(currentAmplitude - maxChange,
+                              currentAmplitude + maxChange, endAmplitude);
+
+  float incrementStep = (endIncrement - currentIncrement) / blockLength;
+  float amplitudeStep = (endAmplitude - currentAmplitude) / blockLength;
+  juce::FloatVectorOperations::copyWithMultiply(
+      incrementRamp.data(), rampSteps.data(), incrementStep, blockLength);
+  juce::FloatVectorOperations::add(incrementRamp.data(), currentIncrement,
+                                   blockLength);
+  juce::FloatVectorOperations::copyWithMultiply(
+      amplitudeRamp.data(), rampSteps.data(), amplitudeStep, blockLength);
+  juce::FloatVectorOperations::add(amplitudeRamp.data(), currentAmplitude,
+                                   blockLength);
+  currentIncrement = endIncrement;
+  currentAmplitude = endAmplitude;
+
+  // Keep fading out once every point has been played, until silent
+  samplePosition += blockLength;
+  if (isFadingOut) {
+    hasFinished = currentAmplitude <= 0.0f;
+  } else if (samplePosition >= (juce::int64)numPoints * samplesPerPoint) {
+    isFadingOut = true;
+  }
+
+  return blockLength;
+}
+
+void ControlRateRenderer::renderWaveform(float* output, int numSamples,
+                                         Waveform waveform) noexcept {
+  // The phase accumulator is the only serial dependency, so run it first and
+  // leave the waveform and gain loops free to vectorise
+  for (int i = 0; i < numSamples; i++) {
+    phases[i] = (float)phase;
+    phase += incrementRamp[i];
+    if (phase >= 1.0) phase -= 1.0;
+  }
+
+  const float* p = phases.data();
+  switch (waveform) {
+    case Waveform::kSine:
+      // Linear interpolation between table entries, whose error is below
+      // -100 dB. A phase that rounded up to 1 reads the final entry.
+      for (int i = 0; i < numSamples; i++) {
+        float position = p[i] * (float)kSineTableSize;
+        int index = juce::jmin((int)position, kSineTableSize - 1);
+        float fraction = position - (float)index;
+        output[i] = sineTable[index] +
+                    fraction * (sineTable[index + 1] - sineTable[index]);
+      }
+      break;
+    case Waveform::kSquare:
+      for (int i = 0; i < numSamples; i++) {
+        output[i] = p[i] <= 0.5f ? -1.0f : 1.0f;
+      }
+      break;
+    case Waveform::kTriangle:
+      for (int i = 0; i < numSamples; i++) {
+        output[i] = p[i] <= 0.5f ? 4.0f * p[i] - 1.0f : 3.0f - 4.0f * p[i];
+      }
+      break;
+    case Waveform::kSaw:
+      for (int i = 0; i < numSamples; i++) {
+        output[i] = 2.0f * p[i] - 1.0f;
+      }
+      break;
+  }
+
+  juce::FloatVectorOperations::multiply(output, amplitudeRamp.data(),
+                                        numSamples);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "Waveform.h"
+
+//==============================================================================
+/*
+    Plays a series of data points as one continuous tone, gliding in pitch
+    between points instead of stepping from note to note.
+
+    Pitch and amplitude are only evaluated once per control block (every
+    controlInterval samples). Within a block, the audio-rate loops just follow
+    linear ramps between the block's start and end values, so there is no
+    per-sample parameter logic and no clicks at point boundaries. The ramps
+    are built with FloatVectorOperations, and the sine is read from a table
+    rather than computed for every sample.
+*/
+class ControlRateRenderer {
+ public:
+  static constexpr int kDefaultControlInterval = 32;
+  static constexpr int kSineTableSize = 1024;
+
+  /** Allocates the ramp buffers and sine table. Call before rendering, off
+      the audio thread or from prepareToPlay(). */
+  void prepare(double newSampleRate, int newControlInterval);
+
+  /**
+   * Starts gliding through pitches (fractional MIDI notes), spending
+   * samplesPerPoint samples on each. The pitches must stay alive while
+   * rendering.
+   */
+  void start(const double* newPitches, int newNumPoints,
+             int newSamplesPerPoint) noexcept;
+
+  /** Sets the level that the next control block will ramp towards */
+  void setAmplitude(double newAmplitude) noexcept {
+    targetAmplitude = (float)newAmplitude;
+  }
+
+  /**
+   * Renders the next numSamples samples. Returns false once the series has
+   * ended and faded out, after which the rest of the output is silent.
+   */
+  bool render(float* output, int numSamples, Waveform waveform) noexcept;
+
+  /** Returns the data point currently being played */
+  int getCurrentPoint() const noexcept;
+
+ private:
+  /** Fills the ramps for one control block and returns its length */
+  int prepareControlBlock(int maxSamples) noexcept;
+  void renderWaveform(float* output, int numSamples,
+                      Waveform waveform) noexcept;
+
+  double sampleRate = 44100.0;
+  int controlInterval = kDefaultControlInterval;
+
+  const double* pitches = nullptr;
+  int numPoints = 0;
+  int samplesPerPoint = 1;
+  juce::int64 samplePosition = 0;
+  bool isFadingOut = false;
+  bool hasFinished = true;
+
+  double phase = 0.0;
+  float currentIncrement = 0.0f;
+  float currentAmplitude = 0.0f;
+  float targetAmplitude = 0.0f;
+
+  std::vector<float> incrementRamp;
+  std::vector<float> amplitudeRamp;
+  std::vector<float> phases;
+  /** 1, 2, 3... for scaling a block's step into its ramp */
+  std::vector<float> rampSteps;
+  /** One cycle of a sine, plus its first value again for interpolating */
+  std::vector<float> sineTable;
+};
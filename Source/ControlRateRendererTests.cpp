@@ -0,0 +1,98 @@
+#include <JuceHeader.h>
+
+#include "ControlRateRenderer.h"
+
+//==============================================================================
+/*
+    Renders a series that leaps by octaves, in blocks that line up with
+    neither the control interval nor the points, and checks that the output
+    never jumps further between samples than the waveform itself can. That
+    covers clicks at block and point boundaries, and fading in and out.
+*/
+class ControlRateRendererTests : public juce::UnitTest {
+ public:
+  ControlRateRendererTests()
+      : juce::UnitTest("ControlRateRenderer", "DataSonification") {}
+
+  void runTest() override {
+    for (int blockSize : {1, 37, 512}) {
+      beginTest("Sine and triangle stay continuous in blocks of " +
+                juce::String(blockSize));
+      checkContinuity(Waveform::kSine, blockSize,
+                      juce::MathConstants<double>::twoPi);
+      checkContinuity(Waveform::kTriangle, blockSize, 4.0);
+    }
+
+    beginTest("A steady pitch plays at its full level");
+    {
+      ControlRateRenderer renderer;
+      renderer.prepare(kSampleRate, kControlInterval);
+      renderer.setAmplitude(kAmplitude);
+      const double pitch = 69.0;
+      renderer.start(&pitch, 1, static_cast<int>(kSampleRate));
+
+      std::vector<float> output(static_cast<size_t>(kSampleRate));
+      expect(renderer.render(output.data(), (int)output.size() / 2,
+                             Waveform::kSine));
+      auto range = juce::FloatVectorOperations::findMinAndMax(
+          output.data() + kControlInterval,
+          (int)output.size() / 2 - kControlInterval);
+      expectWithinAbsoluteError(range.getEnd(), (float)kAmplitude, 1.0e-3f);
+      expectWithinAbsoluteError(range.getStart(), (float)-kAmplitude, 1.0e-3f);
+    }
+  }
+
+ private:
+  static constexpr double kSampleRate = 44100.0;
+  static constexpr int kControlInterval = 32;
+  static constexpr int kSamplesPerPoint = 150;
+  static constexpr double kAmplitude = 0.5;
+
+  /**
+   * slope is the waveform's largest change per cycle, at full level, so the
+   * output can change by at most slope * amplitude * frequency / sampleRate
+   * per sample, plus whatever the level ramps by
+   */
+  void checkContinuity(Waveform waveform, int blockSize, double slope) {
+    const std::vector<double> pitches{48.0, 72.0, 48.0, 60.0, 84.0, 84.0};
+    double highestFrequency = 440.0 * std::exp2((84.0 - 69.0) / 12.0);
+    double maxStep = slope * kAmplitude * highestFrequency / kSampleRate +
+                     1.0 / kControlInterval + 1.0e-4;
+
+    ControlRateRenderer renderer;
+    renderer.prepare(kSampleRate, kControlInterval);
+    renderer.setAmplitude(kAmplitude);
+    renderer.start(pitches.data(), (int)pitches.size(), kSamplesPerPoint);
+
+    std::vector<float> output;
+    std::vector<float> block(static_cast<size_t>(blockSize));
+    int maxLength = (int)pitches.size() * kSamplesPerPoint + 2 * blockSize +
+                    2 * kControlInterval;
+    bool isPlaying = true;
+    while (isPlaying && (int)output.size() < maxLength) {
+      isPlaying = renderer.render(block.data(), blockSize, waveform);
+      output.insert(output.end(), block.begin(), block.end());
+    }
+    expect(!isPlaying, "The series never ended");
+
+    // Starting from silence means the first sample is checked too
+    float previous = 0.0f;
+    float largestStep = 0.0f;
+    for (auto sample : output) {
+      largestStep = juce::jmax(largestStep, std::abs(sample - previous));
+      previous = sample;
+    }
+    expectLessThan(largestStep, (float)maxStep);
+
+    // Fades out to silence, and stays there
+    auto last = std::find_if(output.rbegin(), output.rend(),
+                             [](float sample) { return sample != 0.0f; });
+    expect(last != output.rend() &&
+           std::abs(*last) < (float)(1.0 / kControlInterval) + 1.0e-4f);
+    expect(!renderer.render(block.data(), blockSize, waveform));
+    expect(std::all_of(block.begin(), block.end(),
+                       [](float sample) { return sample == 0.0f; }));
+  }
+};
+
+static ControlRateRendererTests controlRateRendererTests;
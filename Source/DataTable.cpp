@@ -0,0 +1,123 @@
+#include "DataTable.h"
+
+bool DataTable::parseCsv(const std::string& csv) {
+  regionNames.clear();
+  days.clear();
+  values.clear();
+
+  const char* position = csv.c_str();
+  const char* csvEnd = position + csv.size();
+
+  // Parse header
+  const char* lineEnd = std::find(position, csvEnd, '\n');
+  if (lineEnd == position) return false;
+
+  std::vector<std::string> header;
+  std::string cell;
+  std::istringstream headerStream(std::string(position, lineEnd));
+  while (std::getline(headerStream, cell, ',')) {
+    if (!cell.empty() && cell.back() == '\r') cell.pop_back();
+    header.push_back(cell);
+  }
+  if (header.empty()) return false;
+  regionNames.assign(header.begin() + 1, header.end());
+
+  // Blank lines are skipped, including those of files with CRLF endings
+  auto isBlank = [](const char* line, const char* end) {
+    return end == line || (end == line + 1 && *line == '\r');
+  };
+
+  // Count rows up front so every column can be stored contiguously
+  const char* firstRow = lineEnd == csvEnd ? csvEnd : lineEnd + 1;
+  int numRows = 0;
+  for (const char* line = firstRow; line < csvEnd;) {
+    const char* end = std::find(line, csvEnd, '\n');
+    if (!isBlank(line, end)) numRows++;
+    line = end == csvEnd ? csvEnd : end + 1;
+  }
+
+  days.reserve(numRows);
+  values.assign(static_cast<size_t>(numRows) * regionNames.size(), 0.0);
+
+  int row = 0;
+  for (const char* line = firstRow; line < csvEnd && row < numRows;) {
+    const char* end = std::find(line, csvEnd, '\n');
+    if (isBlank(line, end)) {
+      line = end == csvEnd ? csvEnd : end + 1;
+      continue;
+    }
+
+    days.push_back(parseDay(line));
+    jassert(row == 0 || days[row - 1] < days[row]);  // must be sorted
+
+    // Rows ending in empty cells are shorter than the header, and the
+    // missing cells keep their value of 0
+    const char* cellStart = std::find(line, end, ',');
+    for (size_t region = 0; region < regionNames.size() && cellStart < end;
+         region++) {
+      cellStart++;
+      if (cellStart < end && *cellStart != ',' && *cellStart != '\r') {
+        values[region * numRows + row] = std::strtod(cellStart, nullptr);
+      }
+      cellStart = std::find(cellStart, end, ',');
+    }
+
+    row++;
+    line = end == csvEnd ? csvEnd : end + 1;
+  }
+
+  return true;
+}
+
+void DataTable::setData(std::vector<std::string> newRegionNames,
+                        std::vector<int> newDays,
+                        std::vector<double> newValues) {
+  jassert(newValues.size() == newRegionNames.size() * newDays.size());
+  regionNames = std::move(newRegionNames);
+  days = std::move(newDays);
+  values = std::move(newValues);
+}
+
+juce::Range<int> DataTable::findRows(int firstDay, int lastDay) const {
+  auto first = std::lower_bound(days.begin(), days.end(), firstDay);
+  auto last = std::upper_bound(first, days.end(), lastDay);
+  return {static_cast<int>(first - days.begin()),
+          static_cast<int>(last - days.begin())};
+}
+
+DataTable::Slice DataTable::getSlice(int region,
+                                     juce::Range<int> rows) const noexcept {
+  rows = rows.getIntersectionWith({0, getNumRows()});
+  if (region < 0 || region >= getNumRegions()) return {};
+  return {getColumn(region) + rows.getStart(), rows.getStart(),
+          rows.getLength()};
+}
+
+int DataTable::parseDay(const char* date) noexcept {
+  // Taken from: http://howardhinnant.github.io/date_algorithms.html
+  int y = std::atoi(date);
+  unsigned m = static_cast<unsigned>(std::atoi(date + 5));
+  unsigned d = static_cast<unsigned>(std::atoi(date + 8));
+
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+juce::String DataTable::formatDay(int day) {
+  // Taken from: http://howardhinnant.github.io/date_algorithms.html
+  day += 719468;
+  const int era = (day >= 0 ? day : day - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(day - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+  const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+  const int y = static_cast<int>(yoe) + era * 400 + (m <= 2);
+
+  return juce::String::formatted("%04d-%02d-%02d", y, (int)m, (int)d);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    The parsed contents of a dated CSV table (one date column followed by one
+    column per region). Dates are packed into day numbers, and each region's
+    values are stored contiguously so that a date range of any region can be
+    handed out as a slice without copying.
+*/
+class DataTable {
+ public:
+  /** A read-only view of consecutive rows of one region's column */
+  struct Slice {
+    const double* values = nullptr;
+    int firstRow = 0;
+    int numRows = 0;
+
+    const double* begin() const noexcept { return values; }
+    const double* end() const noexcept { return values + numRows; }
+    int size() const noexcept { return numRows; }
+    bool isEmpty() const noexcept { return numRows == 0; }
+    double operator[](int index) const noexcept { return values[index]; }
+  };
+
+  /**
+   * Parses CSV text whose first row holds the column names and whose first
+   * column holds YYYY-MM-DD dates in ascending order. Empty cells become 0.
+   * Returns false if there was no header row.
+   */
+  bool parseCsv(const std::string& csv);
+
+  /**
+   * Replaces the table's contents. Values are column-major, with
+   * newDays.size() values for each region.
+   */
+  void setData(std::vector<std::string> newRegionNames,
+               std::vector<int> newDays, std::vector<double> newValues);
+
+  bool operator==(const DataTable& other) const noexcept {
+    return regionNames == other.regionNames && days == other.days &&
+           values == other.values;
+  }
+
+  int getNumRows() const noexcept { return static_cast<int>(days.size()); }
+  int getNumRegions() const noexcept {
+    return static_cast<int>(regionNames.size());
+  }
+  bool isEmpty() const noexcept { return days.empty(); }
+
+  const std::vector<std::string>& getRegionNames() const noexcept {
+    return regionNames;
+  }
+  const std::vector<int>& getDays() const noexcept { return days; }
+  int getDay(int row) const noexcept { return days[row]; }
+  int getFirstDay() const noexcept { return days.empty() ? 0 : days.front(); }
+  int getLastDay() const noexcept { return days.empty() ? 0 : days.back(); }
+
+  /** Returns a pointer to all getNumRows() values of a region */
+  const double* getColumn(int region) const noexcept {
+    return values.data() + static_cast<size_t>(region) * days.size();
+  }
+
+  /**
+   * Returns the rows whose dates lie within [firstDay, lastDay], found by
+   * binary search
+   */
+  juce::Range<int> findRows(int firstDay, int lastDay) const;
+
+  Slice getSlice(int region, juce::Range<int> rows) const noexcept;
+  Slice getSlice(int region) const noexcept {
+    return getSlice(region, {0, getNumRows()});
+  }
+
+  /** Converts a YYYY-MM-DD date to a count of days since 1970-01-01 */
+  static int parseDay(const char* date) noexcept;
+  static juce::String formatDay(int day);
+
+ private:
+  std::vector<std::string> regionNames;
+  std::vector<int> days;
+  /** Column-major, getNumRows() values per region */
+  std::vector<double> values;
+};
@@ -0,0 +1,102 @@
+#include <JuceHeader.h>
+
+#include "DataTable.h"
+
+//==============================================================================
+/*
+    Checks CSV parsing on the kinds of rows OWID's files contain, the date
+    conversions, and the edges of findRows().
+*/
+class DataTableTests : public juce::UnitTest {
+ public:
+  DataTableTests() : juce::UnitTest("DataTable", "DataSonification") {}
+
+  void runTest() override {
+    beginTest("CSV with CRLF, short rows, empty cells and blank lines");
+    {
+      DataTable table;
+      expect(table.parseCsv("date,A,B,C\r\n"
+                            "2020-01-01,1,2,3\r\n"
+                            "2020-01-02,4\r\n"
+                            "\r\n"
+                            "2020-01-03,,5.5,\r\n"
+                            "\n"
+                            "2020-01-05,-6,,7"));
+      expect(table.getRegionNames() ==
+             std::vector<std::string>{"A", "B", "C"});
+      expect(table.getDays() ==
+             std::vector<int>{DataTable::parseDay("2020-01-01"),
+                              DataTable::parseDay("2020-01-02"),
+                              DataTable::parseDay("2020-01-03"),
+                              DataTable::parseDay("2020-01-05")});
+      expectColumn(table, 0, {1.0, 4.0, 0.0, -6.0});
+      expectColumn(table, 1, {2.0, 0.0, 5.5, 0.0});
+      expectColumn(table, 2, {3.0, 0.0, 0.0, 7.0});
+    }
+
+    beginTest("CSV without rows, or without a header");
+    {
+      DataTable table;
+      expect(table.parseCsv("date,A\n"));
+      expect(table.isEmpty());
+      expectEquals(table.getNumRegions(), 1);
+
+      expect(!table.parseCsv(""));
+      expect(!table.parseCsv("\n2020-01-01,1\n"));
+      expect(table.isEmpty());
+      expectEquals(table.getNumRegions(), 0);
+    }
+
+    beginTest("Dates convert to day numbers and back");
+    expectEquals(DataTable::parseDay("1970-01-01"), 0);
+    expectEquals(DataTable::parseDay("1969-12-31"), -1);
+    expectEquals(DataTable::parseDay("2020-03-01") -
+                     DataTable::parseDay("2020-02-28"),
+                 2);
+    expectEquals(DataTable::parseDay("2021-03-01") -
+                     DataTable::parseDay("2021-02-28"),
+                 1);
+    expectEquals(DataTable::formatDay(0), juce::String("1970-01-01"));
+    expectEquals(DataTable::formatDay(DataTable::parseDay("2000-02-29")),
+                 juce::String("2000-02-29"));
+    for (int day = -1000; day < 40000; day += 7) {
+      auto date = DataTable::formatDay(day);
+      expectEquals(DataTable::parseDay(date.toRawUTF8()), day, date);
+    }
+
+    beginTest("Rows are found for any range of days");
+    {
+      DataTable table;
+      table.setData({"A"}, {10, 11, 12, 15, 16}, {1.0, 2.0, 3.0, 4.0, 5.0});
+      expectRows(table.findRows(0, 5), {0, 0});
+      expectRows(table.findRows(20, 30), {5, 5});
+      expectRows(table.findRows(12, 12), {2, 3});
+      expectRows(table.findRows(13, 14), {3, 3});
+      expectRows(table.findRows(11, 15), {1, 4});
+      expectRows(table.findRows(0, 100), {0, 5});
+      expectRows(table.findRows(16, 16), {4, 5});
+
+      auto slice = table.getSlice(0, table.findRows(11, 15));
+      expectEquals(slice.firstRow, 1);
+      expectEquals(slice.size(), 3);
+      expectEquals(slice[0], 2.0);
+      expect(table.getSlice(1).isEmpty());
+    }
+  }
+
+ private:
+  void expectColumn(const DataTable& table, int region,
+                    const std::vector<double>& expected) {
+    const double* column = table.getColumn(region);
+    expect(std::vector<double>(column, column + table.getNumRows()) ==
+               expected,
+           "Region " + juce::String(region));
+  }
+
+  void expectRows(juce::Range<int> rows, juce::Range<int> expected) {
+    expect(rows == expected, juce::String(rows.getStart()) + ".." +
+                                 juce::String(rows.getEnd()));
+  }
+};
+
+static DataTableTests dataTableTests;
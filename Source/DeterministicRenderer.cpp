@@ -0,0 +1,222 @@
+#include "DeterministicRenderer.h"
+
+namespace {
+// sin(i / 256 * pi / 2) * (2^31 - 1), rounded, for i = 0 to 256. Written out
+// rather than computed so that no maths library is involved.
+const juce::int32 kQuarterSine[257] = {
+    0, 13176712, 26352928, 39528151, 52701887, 65873638, 79042909, 92209205,
+    105372028, 118530885, 131685278, 144834714, 157978697, 171116732, 184248325,
+    197372981, 210490206, 223599506, 236700388, 249792358, 262874923, 275947592,
+    289009871, 302061269, 315101294, 328129457, 341145265, 354148229, 367137860,
+    380113669, 393075166, 406021864, 418953276, 431868915, 444768293, 457650927,
+    470516330, 483364019, 496193509, 509004318, 521795963, 534567963, 547319836,
+    560051103, 572761285, 585449903, 598116478, 610760535, 623381597, 635979190,
+    648552837, 661102068, 673626408, 686125386, 698598533, 711045377, 723465451,
+    735858287, 748223418, 760560379, 772868706, 785147934, 797397602, 809617248,
+    821806413, 833964637, 846091463, 858186434, 870249095, 882278991, 894275670,
+    906238681, 918167571, 930061894, 941921200, 953745043, 965532978, 977284561,
+    988999351, 1000676905, 1012316784, 1023918549, 1035481765, 1047005996,
+    1058490807, 1069935767, 1081340445, 1092704410, 1104027236, 1115308496,
+    1126547765, 1137744620, 1148898640, 1160009404, 1171076495, 1182099495,
+    1193077990, 1204011566, 1214899812, 1225742318, 1236538675, 1247288477,
+    1257991319, 1268646799, 1279254515, 1289814068, 1300325059, 1310787095,
+    1321199780, 1331562722, 1341875532, 1352137822, 1362349204, 1372509294,
+    1382617710, 1392674071, 1402677999, 1412629117, 1422527050, 1432371426,
+    1442161874, 1451898025, 1461579513, 1471205973, 1480777044, 1490292364,
+    1499751575, 1509154322, 1518500249, 1527789006, 1537020243, 1546193612,
+    1555308767, 1564365366, 1573363067, 1582301533, 1591180425, 1599999410,
+    1608758157, 1617456334, 1626093615, 1634669675, 1643184190, 1651636840,
+    1660027308, 1668355276, 1676620431, 1684822463, 1692961061, 1701035921,
+    1709046738, 1716993211, 1724875039, 1732691927, 1740443580, 1748129706,
+    1755750016, 1763304223, 1770792043, 1778213194, 1785567395, 1792854372,
+    1800073848, 1807225552, 1814309215, 1821324571, 1828271355, 1835149305,
+    1841958164, 1848697673, 1855367580, 1861967633, 1868497585, 1874957188,
+    1881346201, 1887664382, 1893911493, 1900087300, 1906191569, 1912224072,
+    1918184580, 1924072870, 1929888719, 1935631909, 1941302224, 1946899450,
+    1952423376, 1957873795, 1963250500, 1968553291, 1973781966, 1978936330,
+    1984016188, 1989021349, 1993951624, 1998806828, 2003586778, 2008291295,
+    2012920200, 2017473320, 2021950483, 2026351521, 2030676268, 2034924561,
+    2039096240, 2043191149, 2047209132, 2051150040, 2055013722, 2058800035,
+    2062508835, 2066139982, 2069693341, 2073168776, 2076566159, 2079885359,
+    2083126253, 2086288719, 2089372637, 2092377891, 2095304369, 2098151959,
+    2100920555, 2103610053, 2106220351, 2108751351, 2111202958, 2113575079,
+    2115867625, 2118080510, 2120213650, 2122266966, 2124240379, 2126133816,
+    2127947205, 2129680479, 2131333571, 2132906419, 2134398965, 2135811152,
+    2137142926, 2138394239, 2139565042, 2140655292, 2141664947, 2142593970,
+    2143442325, 2144209981, 2144896909, 2145503082, 2146028479, 2146473079,
+    2146836865, 2147119824, 2147321945, 2147443221, 2147483647};
+
+// 2^(i / 12), the ratio of each semitone above A
+const double kSemitoneRatios[12] = {
+    1.0,
+    1.0594630943592953,
+    1.122462048309373,
+    1.189207115002721,
+    1.2599210498948732,
+    1.3348398541700344,
+    1.4142135623730951,
+    1.4983070768766815,
+    1.5874010519681994,
+    1.681792830507429,
+    1.7817974362806785,
+    1.8877486253633868};
+
+const juce::int64 kFullScale = (juce::int64)1 << 31;
+const juce::int32 kMaxSample = std::numeric_limits<juce::int32>::max();
+const int kGainBits = 15;
+
+juce::int32 lookUpSine(juce::uint32 phase) noexcept {
+  // Fold the phase into the first quadrant, with 8 bits of table index and
+  // 16 bits of fraction to interpolate with
+  juce::uint32 quadrant = phase >> 30;
+  juce::uint32 position = phase & 0x3fffffffu;
+  if (quadrant & 1) position = 0x40000000u - position;
+
+  juce::uint32 index = position >> 22;
+  juce::int32 value = kQuarterSine[index];
+  if (index < 256) {
+    juce::int64 fraction = (position >> 6) & 0xffff;
+    value += (juce::int32)(
+        ((juce::int64)(kQuarterSine[index + 1] - value) * fraction) >> 16);
+  }
+  return quadrant & 2 ? -value : value;
+}
+
+juce::int32 applyGain(juce::int64 sample, juce::int32 gain) noexcept {
+  return (juce::int32)juce::jlimit(-kFullScale, (juce::int64)kMaxSample,
+                                   (sample * gain) >> kGainBits);
+}
+
+float toFloat(juce::int32 sample) noexcept {
+  // Scaling by a power of two is exact
+  return (float)sample * (1.0f / 2147483648.0f);
+}
+}  // namespace
+
+void DeterministicRenderer::prepare(double newSampleRate) noexcept {
+  for (int note = 0; note < 128; note++) {
+    // Octaves are exact powers of two, so each frequency is 440 Hz times one
+    // of the constant ratios with nothing left to round
+    int semitones = note - 69;
+    int octave = semitones >= 0 ? semitones / 12 : (semitones - 11) / 12;
+    double freq =
+        std::ldexp(440.0 * kSemitoneRatios[semitones - octave * 12], octave);
+    double increment = std::round(freq / newSampleRate * 4294967296.0);
+    incrementForNote[(size_t)note] =
+        (juce::uint32)juce::jlimit(0.0, 4294967295.0, increment);
+  }
+}
+
+void DeterministicRenderer::start(std::vector<Note> newNotes) {
+  notes = std::move(newNotes);
+  currentNote = 0;
+  samplesLeftInNote = notes.empty() ? 0 : notes.front().numSamples;
+  hasFinished = notes.empty();
+  phase = 0;
+  hash = kFnvOffsetBasis;
+}
+
+void DeterministicRenderer::setLevel(double newLevel) noexcept {
+  gain = (juce::int32)std::round(juce::jlimit(0.0, 1.0, newLevel) *
+                                 (1 << kGainBits));
+}
+
+bool DeterministicRenderer::render(float* output, int numSamples,
+                                   Waveform waveform) noexcept {
+  int numRendered = 0;
+  while (numRendered < numSamples && !hasFinished) {
+    // Render up to the end of the current note, then move on to the next
+    int length = juce::jmin(samplesLeftInNote, numSamples - numRendered);
+    renderNote(output + numRendered, length, waveform);
+    numRendered += length;
+    samplesLeftInNote -= length;
+
+    while (samplesLeftInNote <= 0 && !hasFinished) {
+      if (++currentNote >= (int)notes.size()) {
+        currentNote = (int)notes.size() - 1;
+        hasFinished = true;
+      } else {
+        samplesLeftInNote = notes[(size_t)currentNote].numSamples;
+      }
+    }
+  }
+
+  // Only hash what was played, so the block size doesn't change the result
+  hash = hashSamples(output, numRendered, hash);
+
+  if (numRendered < numSamples) {
+    juce::FloatVectorOperations::clear(output + numRendered,
+                                       numSamples - numRendered);
+  }
+  return !hasFinished;
+}
+
+int DeterministicRenderer::getCurrentNote() const noexcept {
+  return currentNote;
+}
+
+juce::uint64 DeterministicRenderer::hashSamples(const float* samples,
+                                                int numSamples,
+                                                juce::uint64 hash) noexcept {
+  for (int i = 0; i < numSamples; i++) {
+    juce::uint32 bits;
+    std::memcpy(&bits, samples + i, sizeof(bits));
+    for (int byte = 0; byte < 4; byte++) {
+      hash = (hash ^ ((bits >> (byte * 8)) & 0xff)) * kFnvPrime;
+    }
+  }
+  return hash;
+}
+
+juce::uint64 DeterministicRenderer::renderHash(std::vector<Note> notes,
+                                               double sampleRate,
+                                               Waveform waveform,
+                                               double level) {
+  DeterministicRenderer renderer;
+  renderer.prepare(sampleRate);
+  renderer.setLevel(level);
+  renderer.start(std::move(notes));
+
+  std::vector<float> block(4096);
+  while (renderer.render(block.data(), (int)block.size(), waveform)) {
+  }
+  return renderer.getHash();
+}
+
+void DeterministicRenderer::renderNote(float* output, int numSamples,
+                                       Waveform waveform) noexcept {
+  int midiNote = juce::jlimit(0, 127, notes[(size_t)currentNote].midiNote);
+  juce::uint32 increment = incrementForNote[(size_t)midiNote];
+
+  // The phase wraps by unsigned overflow, which is exact
+  switch (waveform) {
+    case Waveform::kSine:
+      for (int i = 0; i < numSamples; i++) {
+        output[i] = toFloat(applyGain(lookUpSine(phase), gain));
+        phase += increment;
+      }
+      break;
+    case Waveform::kSquare:
+      for (int i = 0; i < numSamples; i++) {
+        juce::int64 sample = phase <= 0x80000000u ? -kFullScale : kMaxSample;
+        output[i] = toFloat(applyGain(sample, gain));
+        phase += increment;
+      }
+      break;
+    case Waveform::kTriangle:
+      for (int i = 0; i < numSamples; i++) {
+        juce::int64 twice = (juce::int64)phase * 2;
+        juce::int64 sample =
+            phase <= 0x80000000u ? twice - kFullScale : 3 * kFullScale - twice;
+        output[i] = toFloat(applyGain(sample, gain));
+        phase += increment;
+      }
+      break;
+    case Waveform::kSaw:
+      for (int i = 0; i < numSamples; i++) {
+        output[i] = toFloat(applyGain((juce::int64)phase - kFullScale, gain));
+        phase += increment;
+      }
+      break;
+  }
+}
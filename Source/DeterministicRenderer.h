@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "Waveform.h"
+
+//==============================================================================
+/*
+    Plays notes with integer arithmetic only, so the same notes at the same
+    sample rate always render to exactly the same samples, whatever the
+    compiler, optimisation level or maths library.
+
+    The phase is a 32-bit accumulator that wraps instead of calling fmod, the
+    sine comes from a hard-coded quarter-wave table, and the level is applied
+    as a 16-bit fixed-point gain. The only floating-point operations are the
+    once-per-note increment lookup, built from constant semitone ratios, and
+    the final exact scaling of each sample to a float.
+
+    Everything rendered is hashed with 64-bit FNV-1a, so two renders can be
+    compared by their hashes alone.
+*/
+class DeterministicRenderer {
+ public:
+  struct Note {
+    int midiNote;
+    int numSamples;
+  };
+
+  static constexpr juce::uint64 kFnvOffsetBasis = 14695981039346656037ull;
+  static constexpr juce::uint64 kFnvPrime = 1099511628211ull;
+
+  /** Recomputes every note's phase increment. Doesn't allocate. */
+  void prepare(double newSampleRate) noexcept;
+
+  /** Starts playing notes from the beginning, with the phase at zero */
+  void start(std::vector<Note> newNotes);
+
+  /** Sets the level as a fixed-point gain, between 0 and 1 */
+  void setLevel(double newLevel) noexcept;
+
+  /**
+   * Renders the next numSamples samples. Returns false once every note has
+   * been played, after which the rest of the output is silent.
+   */
+  bool render(float* output, int numSamples, Waveform waveform) noexcept;
+
+  /** Returns the note currently being played */
+  int getCurrentNote() const noexcept;
+
+  /** Returns the hash of everything rendered since start() */
+  juce::uint64 getHash() const noexcept { return hash; }
+
+  /**
+   * Folds the bit patterns of samples into an FNV-1a hash, one little-endian
+   * byte at a time, so the result doesn't depend on the machine's byte order.
+   */
+  static juce::uint64 hashSamples(const float* samples, int numSamples,
+                                  juce::uint64 hash = kFnvOffsetBasis) noexcept;
+
+  /** Renders notes offline and returns the hash of the whole output */
+  static juce::uint64 renderHash(std::vector<Note> notes, double sampleRate,
+                                 Waveform waveform, double level);
+
+ private:
+  void renderNote(float* output, int numSamples, Waveform waveform) noexcept;
+
+  std::array<juce::uint32, 128> incrementForNote{};
+
+  std::vector<Note> notes;
+  int currentNote = 0;
+  int samplesLeftInNote = 0;
+  bool hasFinished = true;
+
+  juce::uint32 phase = 0;
+  juce::int32 gain = 0;
+  juce::uint64 hash = kFnvOffsetBasis;
+};
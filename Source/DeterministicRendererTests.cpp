@@ -0,0 +1,98 @@
+#include <JuceHeader.h>
+
+#include "DeterministicRenderer.h"
+#include "Scale.h"
+
+//==============================================================================
+/*
+    Pins the hash of every waveform in every scale, so that any change to the
+    samples the deterministic renderer produces fails here. A change that is
+    meant to alter the output has to update the hashes below, which the failure
+    messages print.
+
+    Tools/determinism builds these same tests without JUCE at different
+    optimisation levels, to check they pass regardless of the compiler flags.
+*/
+class DeterministicRendererTests : public juce::UnitTest {
+ public:
+  DeterministicRendererTests()
+      : juce::UnitTest("DeterministicRenderer", "DataSonification") {}
+
+  void runTest() override {
+    beginTest("Every waveform and scale renders its pinned hash");
+    for (const auto& golden : kGoldenHashes) {
+      auto hash = DeterministicRenderer::renderHash(
+          makeNotes(golden.scaleId), kSampleRate, golden.waveform, kLevel);
+      expectEquals(toHex(hash), toHex(golden.hash),
+                   "Waveform " + juce::String((int)golden.waveform) +
+                       ", scale " + juce::String((int)golden.scaleId));
+    }
+
+    beginTest("The block size doesn't change the hash");
+    auto notes = makeNotes(Scale::kDiatonic);
+    auto expected = DeterministicRenderer::renderHash(
+        notes, kSampleRate, Waveform::kTriangle, kLevel);
+    for (int blockSize : {1, 64, 333, 512, 4096}) {
+      DeterministicRenderer renderer;
+      renderer.prepare(kSampleRate);
+      renderer.setLevel(kLevel);
+      renderer.start(notes);
+
+      std::vector<float> block(static_cast<size_t>(blockSize));
+      while (renderer.render(block.data(), blockSize, Waveform::kTriangle)) {
+      }
+      expectEquals(toHex(renderer.getHash()), toHex(expected),
+                   "Block size " + juce::String(blockSize));
+    }
+  }
+
+ private:
+  struct GoldenHash {
+    Waveform waveform;
+    Scale::ScaleId scaleId;
+    juce::uint64 hash;
+  };
+
+  static constexpr double kSampleRate = 44100.0;
+  static constexpr double kLevel = 0.5;
+  static constexpr int kNumNotes = 40;
+
+  static const GoldenHash kGoldenHashes[16];
+
+  /** Spreads notes over a few octaves and quantizes them like the app does */
+  static std::vector<DeterministicRenderer::Note> makeNotes(
+      Scale::ScaleId scaleId) {
+    std::vector<DeterministicRenderer::Note> notes;
+    for (int i = 0; i < kNumNotes; i++) {
+      double pitch = 40.0 + (i * 7) % 40 + 0.5;
+      notes.push_back({Scale::quantize(pitch, scaleId), 1000 + i * 37});
+    }
+    return notes;
+  }
+
+  static juce::String toHex(juce::uint64 hash) {
+    return juce::String::toHexString(static_cast<juce::int64>(hash));
+  }
+};
+
+const DeterministicRendererTests::GoldenHash
+    DeterministicRendererTests::kGoldenHashes[16] = {
+        {Waveform::kSine, Scale::kChromatic, 0xee87e3b9102e5c61ull},
+        {Waveform::kSine, Scale::kDiatonic, 0xfdd9718cfae3d6ebull},
+        {Waveform::kSine, Scale::kPentatonic, 0xa0950f56f71c958full},
+        {Waveform::kSine, Scale::kWholeTone, 0x0a8533638d2389c7ull},
+        {Waveform::kSquare, Scale::kChromatic, 0x5fe01b2c05ada805ull},
+        {Waveform::kSquare, Scale::kDiatonic, 0x1a3bd890bb597005ull},
+        {Waveform::kSquare, Scale::kPentatonic, 0x679d269dfcb93505ull},
+        {Waveform::kSquare, Scale::kWholeTone, 0xa9386541d5efcb05ull},
+        {Waveform::kTriangle, Scale::kChromatic, 0xd6002f1cd80603e4ull},
+        {Waveform::kTriangle, Scale::kDiatonic, 0xa0a71df4e27e1d0bull},
+        {Waveform::kTriangle, Scale::kPentatonic, 0xbb774e658a7544e3ull},
+        {Waveform::kTriangle, Scale::kWholeTone, 0xa4280f878dbe46f7ull},
+        {Waveform::kSaw, Scale::kChromatic, 0x0877ae8df1ec7649ull},
+        {Waveform::kSaw, Scale::kDiatonic, 0x3a8678a413c9fec2ull},
+        {Waveform::kSaw, Scale::kPentatonic, 0x7ce69a3b837f69d1ull},
+        {Waveform::kSaw, Scale::kWholeTone, 0x7468443ecf390e14ull},
+};
+
+static DeterministicRendererTests deterministicRendererTests;
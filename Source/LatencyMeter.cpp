@@ -0,0 +1,203 @@
+#include "LatencyMeter.h"
+
+LatencyMeter::LatencyMeter(juce::AudioDeviceManager& audioDeviceManager)
+    : deviceManager(audioDeviceManager), burst(kBurstLength) {
+  // White noise correlates sharply with itself and poorly with anything else,
+  // and a fixed seed plays the same burst every time
+  juce::Random random(0x5eed);
+  for (auto& sample : burst) sample = (random.nextFloat() * 2.0f - 1.0f) * 0.5f;
+}
+
+LatencyMeter::~LatencyMeter() {
+  stopTimer();
+  if (measuring) deviceManager.removeAudioCallback(this);
+}
+
+void LatencyMeter::start(std::function<void(const Result&)> onFinished) {
+  if (measuring) return;
+  measuring = true;
+  onMeasured = std::move(onFinished);
+
+  if (juce::RuntimePermissions::isRequired(
+          juce::RuntimePermissions::recordAudio) &&
+      !juce::RuntimePermissions::isGranted(
+          juce::RuntimePermissions::recordAudio)) {
+    juce::RuntimePermissions::request(
+        juce::RuntimePermissions::recordAudio, [this](bool granted) {
+          if (granted) {
+            openInputAndStart();
+          } else {
+            Result result;
+            result.error = "Permission to record audio was denied";
+            finish(result);
+          }
+        });
+    return;
+  }
+
+  openInputAndStart();
+}
+
+void LatencyMeter::openInputAndStart() {
+  // Open the first channel of the default input alongside the current output
+  previousSetup = deviceManager.getAudioDeviceSetup();
+  auto setup = previousSetup;
+  if (setup.inputDeviceName.isEmpty()) {
+    if (auto* type = deviceManager.getCurrentDeviceTypeObject()) {
+      auto inputNames = type->getDeviceNames(true);
+      int defaultInput = type->getDefaultDeviceIndex(true);
+      if (juce::isPositiveAndBelow(defaultInput, inputNames.size())) {
+        setup.inputDeviceName = inputNames[defaultInput];
+      }
+    }
+  }
+  setup.useDefaultInputChannels = false;
+  setup.inputChannels.clear();
+  setup.inputChannels.setBit(0);
+
+  auto error = deviceManager.setAudioDeviceSetup(setup, true);
+  auto* device = deviceManager.getCurrentAudioDevice();
+  if (error.isEmpty() &&
+      (device == nullptr || device->getActiveInputChannels().isZero())) {
+    error = "No audio input is available to measure with";
+  }
+  if (error.isNotEmpty()) {
+    deviceManager.setAudioDeviceSetup(previousSetup, true);
+    Result result;
+    result.error = error;
+    finish(result);
+    return;
+  }
+
+  // Adding the callback calls audioDeviceAboutToStart() straight away
+  deviceManager.addAudioCallback(this);
+  startTime = juce::Time::getMillisecondCounterHiRes();
+  startTimer(50);
+}
+
+void LatencyMeter::audioDeviceAboutToStart(juce::AudioIODevice* device) {
+  sampleRate = device->getCurrentSampleRate();
+  leadInSamples = static_cast<int>(sampleRate * kLeadInSeconds);
+  reportedInputSamples = device->getInputLatencyInSamples();
+  reportedOutputSamples = device->getOutputLatencyInSamples();
+  recording.assign(static_cast<size_t>(sampleRate * kRecordSeconds), 0.0f);
+  samplePosition = 0;
+  numRecorded = 0;
+}
+
+void LatencyMeter::audioDeviceIOCallback(const float** inputChannelData,
+                                         int numInputChannels,
+                                         float** outputChannelData,
+                                         int numOutputChannels,
+                                         int numSamples) {
+  // Play the burst after a short lead-in, and record the first input until
+  // the recording is full
+  auto numToRecord = static_cast<juce::int64>(recording.size());
+  const float* input = numInputChannels > 0 ? inputChannelData[0] : nullptr;
+  for (int i = 0; i < numSamples; i++) {
+    auto position = samplePosition + i;
+    auto burstOffset = position - leadInSamples;
+    float sample = burstOffset >= 0 && burstOffset < kBurstLength
+                       ? burst[static_cast<size_t>(burstOffset)]
+                       : 0.0f;
+    for (int channel = 0; channel < numOutputChannels; channel++) {
+      if (outputChannelData[channel] != nullptr) {
+        outputChannelData[channel][i] = sample;
+      }
+    }
+
+    if (position < numToRecord) {
+      recording[static_cast<size_t>(position)] =
+          input != nullptr ? input[i] : 0.0f;
+    }
+  }
+
+  samplePosition += numSamples;
+  numRecorded = static_cast<int>(juce::jmin(samplePosition, numToRecord));
+}
+
+void LatencyMeter::timerCallback() {
+  bool isRecorded = numRecorded >= static_cast<int>(recording.size());
+  bool hasTimedOut = juce::Time::getMillisecondCounterHiRes() - startTime >
+                     kTimeoutSeconds * 1000.0;
+  if (!isRecorded && !hasTimedOut) return;
+
+  stopTimer();
+  deviceManager.removeAudioCallback(this);
+
+  Result result;
+  if (isRecorded) {
+    result = analyse();
+  } else {
+    result.error = "The audio device stopped while measuring";
+  }
+
+  deviceManager.setAudioDeviceSetup(previousSetup, true);
+  finish(result);
+}
+
+LatencyMeter::Result LatencyMeter::analyse() const {
+  Result result;
+  int maxLag =
+      static_cast<int>(recording.size()) - leadInSamples - kBurstLength;
+  if (maxLag < 0) {
+    result.error = "The recording was too short";
+    return result;
+  }
+
+  // Slide the burst along the recording, keeping a running total of the
+  // energy under it so each lag's correlation can be normalized
+  double burstEnergy = 0.0;
+  double windowEnergy = 0.0;
+  const float* recorded = recording.data() + leadInSamples;
+  for (int i = 0; i < kBurstLength; i++) {
+    burstEnergy += burst[i] * burst[i];
+    windowEnergy += recorded[i] * recorded[i];
+  }
+
+  int bestLag = 0;
+  double bestCorrelation = 0.0;
+  for (int lag = 0; lag <= maxLag; lag++) {
+    const float* window = recorded + lag;
+    double correlation = 0.0;
+    for (int i = 0; i < kBurstLength; i++) correlation += burst[i] * window[i];
+
+    if (windowEnergy > 0.0) {
+      double normalized =
+          std::abs(correlation) / std::sqrt(burstEnergy * windowEnergy);
+      if (normalized > bestCorrelation) {
+        bestCorrelation = normalized;
+        bestLag = lag;
+      }
+    }
+
+    if (lag < maxLag) {
+      windowEnergy += window[kBurstLength] * window[kBurstLength] -
+                      window[0] * window[0];
+      windowEnergy = juce::jmax(0.0, windowEnergy);
+    }
+  }
+
+  if (bestCorrelation < kMinCorrelation) {
+    result.error =
+        "The test signal wasn't heard. Connect an output to an input, or "
+        "turn up the speakers near the microphone, and try again.";
+    return result;
+  }
+
+  auto toMs = [this](int samples) { return samples * 1000.0 / sampleRate; };
+  result.succeeded = true;
+  result.roundTripMs = toMs(bestLag);
+  result.reportedInputMs = toMs(reportedInputSamples);
+  result.reportedOutputMs = toMs(reportedOutputSamples);
+  result.outputMs =
+      juce::jmax(0.0, result.roundTripMs - result.reportedInputMs);
+  return result;
+}
+
+void LatencyMeter::finish(const Result& result) {
+  measuring = false;
+  auto callback = std::move(onMeasured);
+  onMeasured = nullptr;
+  if (callback) callback(result);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Measures the real round-trip latency of the audio device by playing a
+    short noise burst and finding it again in the input, which needs the
+    output looped back to an input (with a cable, or the speakers and a
+    microphone).
+
+    The device's input is only opened while measuring. Afterwards the
+    previous device setup, which may be output-only, is restored.
+*/
+class LatencyMeter : public juce::AudioIODeviceCallback, private juce::Timer {
+ public:
+  struct Result {
+    bool succeeded = false;
+    juce::String error;
+    double roundTripMs = 0.0;
+    double reportedInputMs = 0.0;
+    double reportedOutputMs = 0.0;
+    /** The round trip less the input latency the device reports */
+    double outputMs = 0.0;
+  };
+
+  static constexpr int kBurstLength = 512;
+  static constexpr double kLeadInSeconds = 0.2;
+  static constexpr double kRecordSeconds = 1.0;
+  static constexpr double kTimeoutSeconds = 5.0;
+  /** How closely the input has to match the burst to count as found */
+  static constexpr double kMinCorrelation = 0.3;
+
+  explicit LatencyMeter(juce::AudioDeviceManager& audioDeviceManager);
+  ~LatencyMeter() override;
+
+  /**
+   * Starts a measurement, asking for permission to record first where that's
+   * needed. onFinished is called on the message thread.
+   */
+  void start(std::function<void(const Result&)> onFinished);
+  bool isMeasuring() const noexcept { return measuring; }
+
+  //==============================================================================
+  void audioDeviceIOCallback(const float** inputChannelData,
+                             int numInputChannels, float** outputChannelData,
+                             int numOutputChannels, int numSamples) override;
+  void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+  void audioDeviceStopped() override {}
+
+ private:
+  void openInputAndStart();
+  void timerCallback() override;
+  /** Finds the burst in the recording */
+  Result analyse() const;
+  void finish(const Result& result);
+
+  juce::AudioDeviceManager& deviceManager;
+  juce::AudioDeviceManager::AudioDeviceSetup previousSetup;
+  std::function<void(const Result&)> onMeasured;
+  bool measuring = false;
+  double startTime = 0.0;
+
+  double sampleRate = 44100.0;
+  int leadInSamples = 0;
+  int reportedInputSamples = 0;
+  int reportedOutputSamples = 0;
+  std::vector<float> burst;
+  std::vector<float> recording;
+  juce::int64 samplePosition = 0;
+  std::atomic<int> numRecorded{0};
+};
@@ -29,6 +29,16 @@ class DataSonificationApplication : public juce::JUCEApplication {
     // This method is where you should put your application's initialisation
     // code..
 
+    // Run the unit tests (or benchmarks) without opening a window
+    if (commandLine.contains("--run-tests")) {
+      runTests("DataSonification");
+      return;
+    }
+    if (commandLine.contains("--run-benchmarks")) {
+      runTests("Benchmarks");
+      return;
+    }
+
     mainWindow.reset(new MainWindow(getApplicationName()));
   }
 
@@ -52,6 +62,20 @@ class DataSonificationApplication : public juce::JUCEApplication {
     // the other instance's command-line arguments were.
   }
 
+  /** Runs one category of unit tests and quits, exiting with 1 on failure */
+  void runTests(const juce::String& category) {
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory(category);
+
+    int numFailures = 0;
+    for (int i = 0; i < runner.getNumResults(); i++) {
+      numFailures += runner.getResult(i)->failures;
+    }
+    setApplicationReturnValue(numFailures > 0 ? 1 : 0);
+    quit();
+  }
+
   //==============================================================================
   /*
       This class implements the desktop window that contains an instance of
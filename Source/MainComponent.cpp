@@ -2,11 +2,13 @@
 
 //==============================================================================
 MainComponent::MainComponent() : Thread("COVID-19 Data Sonification") {
+  TRACE_THREAD_NAME("Message");
+
   // Make all child components visible
   addAndMakeVisible(playButton);
   addAndMakeVisible(playLabel);
 
-  addAndMakeVisible(dataMenu);
+  addAndMakeVisible(regionPicker);
   addAndMakeVisible(dataLabel);
   addAndMakeVisible(dateLabel);
   addAndMakeVisible(casesLabel);
@@ -31,20 +33,60 @@ MainComponent::MainComponent() : Thread("COVID-19 Data Sonification") {
 
   addAndMakeVisible(minMaxUnitButton);
 
+  addAndMakeVisible(analyzer);
+  addAndMakeVisible(loadSamplesButton);
+
+  addAndMakeVisible(exportMidiButton);
+  addAndMakeVisible(midiOutButton);
+  addAndMakeVisible(continuousButton);
+  addAndMakeVisible(controlRateMenu);
+  addAndMakeVisible(deterministicButton);
+  addAndMakeVisible(audioSettingsButton);
+
+  addAndMakeVisible(aggregateMenu);
+  addAndMakeVisible(aggregateLabel);
+
+  addAndMakeVisible(versionMenu);
+  addAndMakeVisible(versionLabel);
+
+  addAndMakeVisible(startDateSlider);
+  addAndMakeVisible(startDateLabel);
+  addAndMakeVisible(endDateSlider);
+  addAndMakeVisible(endDateLabel);
+
   // Add listeners to child components
   playButton.addListener(this);
-  dataMenu.addListener(this);
   oscillatorMenu.addListener(this);
   scaleMenu.addListener(this);
+  aggregateMenu.addListener(this);
+  versionMenu.addListener(this);
   levelSlider.addListener(this);
   minPitchSlider.addListener(this);
   maxPitchSlider.addListener(this);
   playbackBpmSlider.addListener(this);
+  exportMidiButton.addListener(this);
+  midiOutButton.addListener(this);
+  loadSamplesButton.addListener(this);
+  continuousButton.addListener(this);
+  controlRateMenu.addListener(this);
+  deterministicButton.addListener(this);
+  audioSettingsButton.addListener(this);
+  startDateSlider.addListener(this);
+  endDateSlider.addListener(this);
 
   // Add items to combo box components
-  oscillatorMenu.addItemList({"Sine", "Square", "Triangle", "Saw"}, kSine);
+  oscillatorMenu.addItemList({"Sine", "Square", "Triangle", "Saw", "Sampler"},
+                             kSine);
   scaleMenu.addItemList({"Chromatic", "Diatonic", "Pentatonic", "Whole Tone"},
-                        kChromatic);
+                        Scale::kChromatic);
+  aggregateMenu.addItemList({"Selected region", "Country total",
+                             "Fastest weekly growth", "Selected region's rank"},
+                            kSelectedRegion);
+  aggregateMenu.setSelectedId(kSelectedRegion, dontSendNotification);
+  for (int interval : {8, 16, 32, 64, 128}) {
+    controlRateMenu.addItem("Glide every " + juce::String(interval), interval);
+  }
+  controlRateMenu.setSelectedId(controlInterval, dontSendNotification);
 
   // Initialize level slider
   levelSlider.setRange(kMinLevel, kMaxLevel);
@@ -67,10 +109,31 @@ MainComponent::MainComponent() : Thread("COVID-19 Data Sonification") {
   playbackBpmSlider.setSliderStyle(Slider::SliderStyle::LinearHorizontal);
   playbackBpmSlider.setValue(playbackBpm);
 
+  // Initialize date range sliders, which show their day numbers as dates
+  for (auto* dateSlider : {&startDateSlider, &endDateSlider}) {
+    dateSlider->setSliderStyle(Slider::SliderStyle::LinearHorizontal);
+    dateSlider->setTextBoxStyle(Slider::TextBoxLeft, false, 90, 22);
+    dateSlider->textFromValueFunction = [](double value) {
+      return DataTable::formatDay(static_cast<int>(value));
+    };
+    dateSlider->valueFromTextFunction = [](const String& text) {
+      return static_cast<double>(DataTable::parseDay(text.toRawUTF8()));
+    };
+    dateSlider->setEnabled(false);
+  }
+
+  // Initialize region picker
+  regionPicker.onRegionChanged = [this](int region) {
+    selectedRegionIndex = region;
+  };
+
   // Initialize play button
   playButton.setEnabled(false);
   drawPlayButton(playButton, true);
 
+  // Initialize sampler
+  samplerVoice.setBank(&sampleBank);
+
   // Initialize MIDI to frequency lookup table
   for (int i = kMinMidiPitch; i <= kMaxMidiPitch; i++) {
     double freq = convertMidiToFreq(i);
@@ -79,34 +142,38 @@ MainComponent::MainComponent() : Thread("COVID-19 Data Sonification") {
 
   // Make sure you set the size of the component after
   // you add any child components.
-  setSize(800, 600);
-
-  // Some platforms require permissions to open input channels so request that
-  // here
-  if (juce::RuntimePermissions::isRequired(
-          juce::RuntimePermissions::recordAudio) &&
-      !juce::RuntimePermissions::isGranted(
-          juce::RuntimePermissions::recordAudio)) {
-    juce::RuntimePermissions::request(
-        juce::RuntimePermissions::recordAudio,
-        [&](bool granted) { setAudioChannels(granted ? 2 : 0, 2); });
-  } else {
-    // Specify the number of input and output channels that we want to open
-    setAudioChannels(2, 2);
-  }
+  setSize(960, 640);
+
+  // Only outputs are opened, so no permission to record is needed. The last
+  // device used is reopened with the last profile.
+  auto savedDeviceState = audioSettings.getSavedDeviceState();
+  setAudioChannels(0, 2, savedDeviceState.get());
+  audioSettings.restore();
 
   audioSourcePlayer.setSource(nullptr);
 
-  // Disable data menu until data is fetched
-  dataMenu.setEnabled(false);
+  // Disable region picker and export until data is fetched
+  regionPicker.setEnabled(false);
+  versionMenu.setEnabled(false);
+  exportMidiButton.setEnabled(false);
   startThread();
-  
+
+#if DATA_SONIFICATION_TRACING
+  setWantsKeyboardFocus(true);
+#endif
+
+  // Redraw the graph at display rate while playing
+  startTimerHz(kGraphFramesPerSecond);
+
   setVisible(true);
 }
 
 MainComponent::~MainComponent() {
   // This shuts down the audio device and clears the audio source.
+  stopTimer();
+  delete audioSettingsWindow.getComponent();
   shutdownAudio();
+  setMidiOutputEnabled(false);
 }
 
 //==============================================================================
@@ -122,10 +189,15 @@ void MainComponent::prepareToPlay(int samplesPerBlockExpected,
   srate = sampleRate;
   phase = 0;
   phaseDelta = currentFreq / srate;
+  visualizationFeed.setSampleRate(sampleRate);
+  controlRateRenderer.prepare(sampleRate, controlInterval);
+  deterministicRenderer.prepare(sampleRate);
 }
 
 void MainComponent::getNextAudioBlock(
     const juce::AudioSourceChannelInfo& bufferToFill) {
+  TRACE_THREAD_NAME("Audio");
+  TRACE_SCOPE("audio block");
   bufferToFill.clearActiveBufferRegion();
 
   if (!isPlaying()) return;
@@ -140,22 +212,41 @@ void MainComponent::getNextAudioBlock(
   double beatsPerSecond = playbackBpm / 60.0;
   int noteDurationInSamples = std::ceil(srate / beatsPerSecond);
 
-  switch (oscillatorId) {
-    case kSine:
-      generateSine(bufferToFill, noteDurationInSamples);
-      break;
-    case kSquare:
-      generateSquare(bufferToFill, noteDurationInSamples);
-      break;
-    case kTriangle:
-      generateTriangle(bufferToFill, noteDurationInSamples);
-      break;
-    case kSaw:
-      generateSaw(bufferToFill, noteDurationInSamples);
-      break;
-    case kNoOscilator:
-      break;
+  if (midiOutputEnabled) {
+    sendMidiNotes(bufferToFill);
+  } else if (isContinuous()) {
+    generateContinuous(bufferToFill);
+  } else if (isDeterministic()) {
+    generateDeterministic(bufferToFill);
+  } else {
+    switch (oscillatorId) {
+      case kSine:
+        generateSine(bufferToFill, noteDurationInSamples);
+        break;
+      case kSquare:
+        generateSquare(bufferToFill, noteDurationInSamples);
+        break;
+      case kTriangle:
+        generateTriangle(bufferToFill, noteDurationInSamples);
+        break;
+      case kSaw:
+        generateSaw(bufferToFill, noteDurationInSamples);
+        break;
+      case kSampler:
+        generateSampler(bufferToFill, noteDurationInSamples);
+        break;
+      case kNoOscilator:
+        break;
+    }
   }
+
+  // Publish the output and position for the GUI, which never blocks
+  if (bufferToFill.buffer->getNumChannels() > 0) {
+    visualizationFeed.pushSamples(
+        bufferToFill.buffer->getReadPointer(0, bufferToFill.startSample),
+        bufferToFill.numSamples);
+  }
+  visualizationFeed.setNoteIndex(currentAmountIndex);
 }
 
 void MainComponent::releaseResources() {
@@ -167,6 +258,7 @@ void MainComponent::releaseResources() {
 
 //==============================================================================
 void MainComponent::paint(juce::Graphics& g) {
+  TRACE_SCOPE("paint");
   // (Our component is opaque, so we must completely fill the background with a
   // solid colour)
   g.fillAll(
@@ -183,9 +275,22 @@ void MainComponent::paint(juce::Graphics& g) {
     maxPitchSlider.setEnabled(true);
     playbackBpmSlider.setEnabled(true);
     oscillatorMenu.setEnabled(true);
-    dataMenu.setEnabled(true);
+    regionPicker.setEnabled(!dataTable.isEmpty());
     scaleMenu.setEnabled(true);
-    
+    aggregateMenu.setEnabled(true);
+    versionMenu.setEnabled(snapshotHistory.getNumSnapshots() > 0 &&
+                           !isThreadRunning());
+    exportMidiButton.setEnabled(!dataTable.isEmpty());
+    startDateSlider.setEnabled(!dataTable.isEmpty());
+    endDateSlider.setEnabled(!dataTable.isEmpty());
+    midiOutButton.setEnabled(true);
+    loadSamplesButton.setEnabled(true);
+    continuousButton.setEnabled(true);
+    controlRateMenu.setEnabled(true);
+    deterministicButton.setEnabled(true);
+    audioSettingsButton.setEnabled(true);
+    setAudioSettingsPlaying(false);
+
     dateLabel.setText("", juce::NotificationType::dontSendNotification);
     casesLabel.setText("", juce::NotificationType::dontSendNotification);
   } else {
@@ -198,26 +303,30 @@ void MainComponent::paint(juce::Graphics& g) {
     g.fillRect(graphBackground);
 
     // Draw entire graph
+    int noteIndex = visualizationFeed.getNoteIndex();
     for (int i = 0; i < amountsToPlay.size(); i++) {
       double amount = amountsToPlay[i];
 
       double widthRatio = (double)(i) / (double)amountsToPlay.size();
       int xCoord = graphArea.getX() + graphArea.getWidth() * widthRatio;
 
-      double heightRatio = (amount - minAmount) / (maxAmount - minAmount);
+      double heightRatio = maxAmount > minAmount
+                               ? (amount - minAmount) / (maxAmount - minAmount)
+                               : 0.0;
       int yCoord = graphArea.getY() + graphArea.getHeight() -
                    graphArea.getHeight() * heightRatio;
 
       Point<int> graphPoint(xCoord, yCoord);
       float pointLength;
 
-      if (i == currentAmountIndex) {
+      if (i == noteIndex) {
         pointLength = 7.0f;
         g.setColour(juce::Colours::orange);
         // Set date label
-        dateLabel.setText(juce::String(rawData[i][0]),
-                          juce::NotificationType::dontSendNotification);
-        casesLabel.setText(juce::String(amount) + " cases",
+        dateLabel.setText(
+            DataTable::formatDay(dataTable.getDay(amountsToPlay.firstRow + i)),
+            juce::NotificationType::dontSendNotification);
+        casesLabel.setText(describeAmount(i),
                            juce::NotificationType::dontSendNotification);
       } else {
         pointLength = 5.0f;
@@ -229,8 +338,6 @@ void MainComponent::paint(juce::Graphics& g) {
       g.fillEllipse(graphPointArea.toFloat());
 
     }
-    
-    repaint();  // FIXME: naive way of showing graph
   }
 }
 
@@ -249,6 +356,12 @@ void MainComponent::resized() {
   auto firstRow = componentBounds.removeFromTop(COL_HEIGHT);
   playLabel.setBounds(firstRow.removeFromLeft(LABEL_WIDTH));
   playButton.setBounds(firstRow.removeFromLeft(COL_HEIGHT));
+  firstRow.removeFromLeft(PADDING);
+  exportMidiButton.setBounds(firstRow.removeFromLeft(MENU_WIDTH));
+  firstRow.removeFromLeft(SLIGHT_PADDING);
+  midiOutButton.setBounds(firstRow.removeFromLeft(MENU_WIDTH));
+  firstRow.removeFromLeft(SLIGHT_PADDING);
+  continuousButton.setBounds(firstRow.removeFromLeft(MENU_WIDTH));
   levelSlider.setBounds(firstRow.removeFromRight(SLIDER_WIDTH));
   levelLabel.setBounds(firstRow.removeFromRight(LABEL_WIDTH));
 
@@ -257,7 +370,7 @@ void MainComponent::resized() {
 
   auto secondRow = componentBounds.removeFromTop(COL_HEIGHT);
   dataLabel.setBounds(secondRow.removeFromLeft(LABEL_WIDTH * 2));
-  dataMenu.setBounds(secondRow.removeFromLeft(MENU_WIDTH));
+  regionPicker.setBounds(secondRow.removeFromLeft(MENU_WIDTH));
 
   auto dataLabelBounds = secondRow.removeFromLeft(LABEL_WIDTH * 2);
   dateLabel.setBounds(dataLabelBounds);
@@ -265,6 +378,8 @@ void MainComponent::resized() {
   casesLabel.setBounds(dataLabelBounds);
   playbackBpmSlider.setBounds(secondRow.removeFromRight(SLIDER_WIDTH));
   playbackBpmLabel.setBounds(secondRow.removeFromRight(LABEL_WIDTH));
+  secondRow.removeFromRight(PADDING);
+  audioSettingsButton.setBounds(secondRow.removeFromRight(MENU_WIDTH));
 
   auto bottomRow = componentBounds.removeFromBottom(COL_HEIGHT);
   auto thirdRow = componentBounds.removeFromBottom(COL_HEIGHT);
@@ -274,11 +389,33 @@ void MainComponent::resized() {
   scaleLabel.setBounds(thirdRow.removeFromLeft(LABEL_WIDTH));
   scaleMenu.setBounds(thirdRow.removeFromLeft(MENU_WIDTH));
   thirdRow.removeFromLeft(SLIGHT_PADDING);
+  deterministicButton.setBounds(thirdRow.removeFromLeft(MENU_WIDTH));
 
   minPitchSlider.setBounds(thirdRow.removeFromRight(SLIDER_WIDTH));
   minPitchLabel.setBounds(thirdRow.removeFromRight(LABEL_WIDTH));
   maxPitchSlider.setBounds(bottomRow.removeFromRight(SLIDER_WIDTH));
   maxPitchLabel.setBounds(bottomRow.removeFromRight(LABEL_WIDTH));
+  aggregateLabel.setBounds(bottomRow.removeFromLeft(LABEL_WIDTH));
+  aggregateMenu.setBounds(bottomRow.removeFromLeft(MENU_WIDTH + LABEL_WIDTH));
+  bottomRow.removeFromLeft(SLIGHT_PADDING);
+  loadSamplesButton.setBounds(bottomRow.removeFromLeft(MENU_WIDTH));
+  bottomRow.removeFromLeft(SLIGHT_PADDING);
+  controlRateMenu.setBounds(bottomRow.removeFromLeft(MENU_WIDTH));
+
+  componentBounds.removeFromBottom(PADDING);
+  auto dateRow = componentBounds.removeFromBottom(COL_HEIGHT);
+  versionLabel.setBounds(dateRow.removeFromLeft(LABEL_WIDTH));
+  versionMenu.setBounds(dateRow.removeFromLeft(MENU_WIDTH + LABEL_WIDTH));
+  dateRow.removeFromLeft(SLIGHT_PADDING);
+  auto startDateBounds = dateRow.removeFromLeft(dateRow.getWidth() / 2);
+  startDateLabel.setBounds(startDateBounds.removeFromLeft(LABEL_WIDTH / 2));
+  startDateSlider.setBounds(startDateBounds);
+  endDateLabel.setBounds(dateRow.removeFromLeft(LABEL_WIDTH / 2));
+  endDateSlider.setBounds(dateRow);
+
+  componentBounds.removeFromBottom(PADDING);
+  analyzer.setBounds(
+      componentBounds.removeFromBottom(componentBounds.getHeight() / 3));
 
   componentBounds.reduce(componentBounds.getWidth() * 0.05,
                          componentBounds.getHeight() * 0.2);
@@ -293,7 +430,20 @@ void MainComponent::sliderValueChanged(Slider* slider) {
   } else if (slider == &maxPitchSlider) {
     maxMidiPitch = slider->getValue();
   } else if (slider == &playbackBpmSlider) {
-    playbackBpm = slider->getValue();
+    if (isContinuous()) {
+      pointsPerSecond = slider->getValue();
+    } else {
+      playbackBpm = slider->getValue();
+    }
+  } else if (slider == &startDateSlider) {
+    // Keep the range the right way round
+    if (startDateSlider.getValue() > endDateSlider.getValue()) {
+      endDateSlider.setValue(startDateSlider.getValue(), dontSendNotification);
+    }
+  } else if (slider == &endDateSlider) {
+    if (endDateSlider.getValue() < startDateSlider.getValue()) {
+      startDateSlider.setValue(endDateSlider.getValue(), dontSendNotification);
+    }
   }
 }
 
@@ -305,25 +455,59 @@ void MainComponent::comboBoxChanged(ComboBox* menu) {
     if (oscillatorId != kNoOscilator) {
       playButton.setEnabled(true);
     }
+    updatePlaybackRateSlider();
   } else if (menu == &scaleMenu) {
-    auto nextScale = ScaleId(kNoScale + index + 1);
+    auto nextScale = Scale::ScaleId(Scale::kNoScale + index + 1);
     scaleId = nextScale;
-  } else if (menu == &dataMenu) {
-    selectedRegionIndex = index;
+  } else if (menu == &controlRateMenu) {
+    // Only changed while stopped, so the audio thread isn't rendering
+    controlInterval = menu->getSelectedId();
+    controlRateRenderer.prepare(srate, controlInterval);
+  } else if (menu == &aggregateMenu) {
+    aggregateModeId = AggregateModeId(kNoAggregateMode + index + 1);
+  } else if (menu == &versionMenu) {
+    // Decode and index the version on the loader thread, as the download is,
+    // since both take too long for the message thread with 100k series. The
+    // menu stays disabled until it's done.
+    if (!isThreadRunning()) {
+      versionToLoad = index;
+      versionMenu.setEnabled(false);
+      startThread();
+    }
   }
 }
 
 void MainComponent::buttonClicked(Button* button) {
+  TRACE_SCOPE("buttonClicked");
   if (button == &playButton) {
     if (isPlaying()) {
       // Stop playback
       audioSourcePlayer.setSource(nullptr);
       notesToPlay.clear();
+
+      // Silence anything still sounding on the MIDI output
+      midiNoteSender.clear();
     } else {
+      // The latency test signal would play over the sonification
+      if (audioSettings.getLatencyMeter().isMeasuring()) return;
+      // The data can't change while playing, and the loader thread replaces it
+      // when it finishes
+      if (isThreadRunning()) return;
+
       // Generate notes to play
-      amountsToPlay = getRegionAmounts();
+      amountsToPlay = aggregateModeId == kSelectedRegion
+                          ? getRegionAmounts()
+                          : getAggregateAmounts();
+      if (amountsToPlay.isEmpty()) return;
       notesToPlay = convertAmountsToNotes(amountsToPlay);
       currentAmountIndex = 0;
+      lastMidiNote = -1;
+      samplerNoteIndex = -1;
+      if (isContinuous()) {
+        startContinuous();
+      } else if (isDeterministic()) {
+        startDeterministic();
+      }
 
       // Set frequency
       currentFreq = midiToFreqTable[notesToPlay.begin()->first];
@@ -335,48 +519,186 @@ void MainComponent::buttonClicked(Button* button) {
       maxPitchSlider.setEnabled(false);
       playbackBpmSlider.setEnabled(false);
       oscillatorMenu.setEnabled(false);
-      dataMenu.setEnabled(false);
+      regionPicker.setEnabled(false);
       scaleMenu.setEnabled(false);
+      aggregateMenu.setEnabled(false);
+      versionMenu.setEnabled(false);
+      exportMidiButton.setEnabled(false);
+      midiOutButton.setEnabled(false);
+      loadSamplesButton.setEnabled(false);
+      continuousButton.setEnabled(false);
+      controlRateMenu.setEnabled(false);
+      deterministicButton.setEnabled(false);
+      audioSettingsButton.setEnabled(false);
+      setAudioSettingsPlaying(true);
+      startDateSlider.setEnabled(false);
+      endDateSlider.setEnabled(false);
+
+      // Start the visualizations from scratch
+      visualizationFeed.reset();
+      analyzer.clear();
 
       // Generate audio
       audioSourcePlayer.setSource(this);
     }
+  } else if (button == &loadSamplesButton) {
+    fileChooser = std::make_unique<FileChooser>(
+        "Choose a sample bank, or a folder of samples to convert",
+        File::getSpecialLocation(File::userDocumentsDirectory), "*.dsbank");
+    fileChooser->launchAsync(
+        FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles |
+            FileBrowserComponent::canSelectDirectories,
+        [this](const FileChooser& chooser) {
+          auto result = chooser.getResult();
+          if (result != File()) loadSampleBank(result);
+        });
+  } else if (button == &continuousButton) {
+    continuousMode = continuousButton.getToggleState();
+    updatePlaybackRateSlider();
+  } else if (button == &deterministicButton) {
+    deterministicMode = deterministicButton.getToggleState();
+  } else if (button == &audioSettingsButton) {
+    showAudioSettings();
+  } else if (button == &midiOutButton) {
+    setMidiOutputEnabled(midiOutButton.getToggleState());
+  } else if (button == &exportMidiButton) {
+    fileChooser = std::make_unique<FileChooser>(
+        "Choose a folder to export MIDI files to",
+        File::getSpecialLocation(File::userDocumentsDirectory));
+    fileChooser->launchAsync(
+        FileBrowserComponent::openMode |
+            FileBrowserComponent::canSelectDirectories,
+        [this](const FileChooser& chooser) {
+          auto directory = chooser.getResult();
+          if (directory.isDirectory()) exportAllRegionsToMidi(directory);
+        });
   }
 }
 
 void MainComponent::run() {
+  TRACE_THREAD_NAME("Loader");
+
+  // Read a version picked from the menu, or fetch the latest one
+  DataTable parsedTable;
+  int version = versionToLoad.exchange(-1);
+  if (version >= 0) {
+    TRACE_SCOPE("history");
+    snapshotHistory.readSnapshot(version, parsedTable);
+  } else {
+    parsedTable = fetchLatestTable();
+  }
+  if (parsedTable.isEmpty()) return;
+
+  // Index the region names too, so searching never waits on the data
+  RegionIndex parsedIndex;
+  {
+    TRACE_SCOPE("index");
+    parsedIndex.build(parsedTable);
+  }
+
+  MessageManagerLock mml(this);
+
+  if (mml.lockWasGained()) {
+    setDataTable(std::move(parsedTable), std::move(parsedIndex));
+    if (version < 0) updateVersionMenu();
+    repaint();
+  }
+}
+
+DataTable MainComponent::fetchLatestTable() {
   juce::String url =
       "https://raw.githubusercontent.com/owid/covid-19-data/master/public/data/"
       "jhu/new_cases.csv";
-  auto result = getResultText(url);
+  juce::String result;
+  {
+    TRACE_SCOPE("download");
+    result = getResultText(url);
+  }
 
-  MessageManagerLock mml(this);
+  // Parse all raw data once, before taking the message thread's lock
+  DataTable parsedTable;
+  {
+    TRACE_SCOPE("parse");
+    parsedTable.parseCsv(result.toStdString());
+  }
 
-  if (mml.lockWasGained()) {
-    // Parse all raw data
-    std::istringstream lineStream(result.toStdString());
-    std::string lineToken;
-    while (std::getline(lineStream, lineToken, '\n')) {
-      std::istringstream commaStream(lineToken);
-      std::string commaToken;
-      std::vector<std::string> strArr;
-      while (std::getline(commaStream, commaToken, ',')) {
-        strArr.push_back(commaToken);
-      }
-      rawData.push_back(strArr);
-    }
+  // Keep this version so it can be replayed after future revisions, or fall
+  // back to the latest stored version if the download failed
+  TRACE_SCOPE("history");
+  if (!parsedTable.isEmpty()) {
+    snapshotHistory.addSnapshot(parsedTable, Time::getCurrentTime());
+  } else if (snapshotHistory.getNumSnapshots() > 0) {
+    snapshotHistory.readSnapshot(snapshotHistory.getNumSnapshots() - 1,
+                                 parsedTable);
+  }
+  return parsedTable;
+}
 
-    // Populate names
-    std::vector<std::string> names = rawData[0];
-    for (int i = 1; i < names.size(); i++) {
-      dataMenu.addItem(juce::String(names[i]), i);
-      regionNames.push_back(names[i]);
-    }
+void MainComponent::timerCallback() {
+  // Keep repainting while playing, plus once more to show that it stopped
+  bool playing = isPlaying();
+  if (playing || wasPlaying) repaint();
 
-    repaint();
+  // Log deterministic renders so they can be compared across builds
+  if (wasPlaying && !playing && isDeterministic() && !isContinuous()) {
+    DBG("Render hash: " << String::toHexString(
+            static_cast<int64>(deterministicRenderer.getHash())));
+  }
+  wasPlaying = playing;
+}
+
+void MainComponent::setDataTable(DataTable&& table, RegionIndex&& index) {
+  // Keep the same region selected if the new table still has it
+  int previousRegion = regionPicker.getSelectedRegion();
+  std::string selectedRegion =
+      previousRegion >= 0 ? regionPicker.getIndex().getName(previousRegion)
+                          : std::string();
+  dataTable = std::move(table);
+
+  regionPicker.setIndex(std::move(index));
+  selectedRegionIndex =
+      jmax(0, regionPicker.getIndex().findRegion(selectedRegion));
+  if (dataTable.getNumRegions() > 0) {
+    regionPicker.setSelectedRegion(selectedRegionIndex, dontSendNotification);
+  }
+
+  // Select every date by default
+  for (auto* dateSlider : {&startDateSlider, &endDateSlider}) {
+    dateSlider->setRange(dataTable.getFirstDay(),
+                         juce::jmax(dataTable.getFirstDay() + 1,
+                                    dataTable.getLastDay()),
+                         1);
   }
+  startDateSlider.setValue(dataTable.getFirstDay(), dontSendNotification);
+  endDateSlider.setValue(dataTable.getLastDay(), dontSendNotification);
 }
 
+void MainComponent::updateVersionMenu() {
+  versionMenu.clear(dontSendNotification);
+  int numSnapshots = snapshotHistory.getNumSnapshots();
+  for (int i = 0; i < numSnapshots; i++) {
+    versionMenu.addItem(
+        snapshotHistory.getSnapshotTime(i).toString(true, true, false), i + 1);
+  }
+  versionMenu.setSelectedId(numSnapshots, dontSendNotification);
+}
+
+#if DATA_SONIFICATION_TRACING
+bool MainComponent::keyPressed(const KeyPress& key) {
+  auto modifiers = ModifierKeys::commandModifier | ModifierKeys::shiftModifier;
+  if (key == KeyPress('t', modifiers, 0)) {
+    auto traceFile =
+        File::getSpecialLocation(File::userDesktopDirectory)
+            .getNonexistentChildFile("data-sonification-trace", ".json");
+    if (Tracer::writeChromeTrace(traceFile)) {
+      DBG("Wrote trace to " << traceFile.getFullPathName());
+    }
+    return true;
+  }
+  return false;
+}
+#endif
+
 String MainComponent::getResultText(const URL& url) {
   StringPairArray responseHeaders;
   int statusCode = 0;
@@ -503,6 +825,137 @@ void MainComponent::generateSaw(const AudioSourceChannelInfo& bufferToFill,
   }
 }
 
+void MainComponent::generateSampler(const AudioSourceChannelInfo& bufferToFill,
+                                    int noteDuration) {
+  // Render the first channel and copy it, rather than replaying the voice
+  auto channelData =
+      bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample);
+
+  for (int i = 0; i < bufferToFill.numSamples; i++) {
+    // Start each note from the top of its zone's preloaded attack
+    if (samplerNoteIndex != currentAmountIndex) {
+      int note = static_cast<int>(notesToPlay[currentAmountIndex].first);
+      auto* zone = sampleBank.getZoneForNote(note);
+      double pitchRatio =
+          zone == nullptr
+              ? 1.0
+              : midiToFreqTable[note] / midiToFreqTable[zone->rootNote];
+      samplerVoice.startNote(zone, pitchRatio, srate);
+      samplerNoteIndex = currentAmountIndex;
+    }
+
+    channelData[i] = level * samplerVoice.getNextSample();
+    bool playbackIsFinished = decrementNoteDurations();
+    if (playbackIsFinished) break;
+  }
+
+  copyFirstChannelToOthers(bufferToFill);
+}
+
+bool MainComponent::isContinuous() {
+  // The sampler always plays discrete notes
+  return continuousMode && oscillatorId != kSampler &&
+         oscillatorId != kNoOscilator;
+}
+
+void MainComponent::startContinuous() {
+  // Same mapping as convertAmountsToNotes(), but neither quantized to the
+  // scale nor truncated to whole notes
+  continuousPitches.clear();
+  for (double amount : amountsToPlay) {
+    double pitch =
+        maxAmount > minAmount
+            ? mapAmount(minAmount, maxAmount, minMidiPitch, maxMidiPitch,
+                        amount)
+            : minMidiPitch;
+    continuousPitches.push_back(pitch);
+  }
+
+  controlRateRenderer.start(continuousPitches.data(),
+                            static_cast<int>(continuousPitches.size()),
+                            roundToInt(srate / pointsPerSecond));
+}
+
+void MainComponent::updatePlaybackRateSlider() {
+  if (isContinuous()) {
+    playbackBpmLabel.setText("Points/s", dontSendNotification);
+    playbackBpmSlider.setRange(kMinPointsPerSecond, kMaxPointsPerSecond, 1);
+    playbackBpmSlider.setValue(pointsPerSecond, dontSendNotification);
+  } else {
+    playbackBpmLabel.setText("BPM", dontSendNotification);
+    playbackBpmSlider.setRange(kMinBpm, kMaxBpm, 1);
+    playbackBpmSlider.setValue(playbackBpm, dontSendNotification);
+  }
+}
+
+void MainComponent::generateContinuous(
+    const AudioSourceChannelInfo& bufferToFill) {
+  // Render the first channel and copy it to the rest
+  controlRateRenderer.setAmplitude(level);
+  bool isStillPlaying = controlRateRenderer.render(
+      bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample),
+      bufferToFill.numSamples, getWaveform());
+
+  copyFirstChannelToOthers(bufferToFill);
+
+  currentAmountIndex = controlRateRenderer.getCurrentPoint();
+  if (!isStillPlaying) notesToPlay.clear();
+}
+
+bool MainComponent::isDeterministic() {
+  // The sampler plays back recorded floating-point audio
+  return deterministicMode && oscillatorId != kSampler &&
+         oscillatorId != kNoOscilator;
+}
+
+void MainComponent::startDeterministic() {
+  std::vector<DeterministicRenderer::Note> notes;
+  notes.reserve(notesToPlay.size());
+  for (const auto& note : notesToPlay) {
+    notes.push_back({static_cast<int>(note.first), note.second});
+  }
+  deterministicRenderer.start(std::move(notes));
+}
+
+void MainComponent::generateDeterministic(
+    const AudioSourceChannelInfo& bufferToFill) {
+  // Render the first channel once and copy it, so the output is the same
+  // whatever the number of channels
+  deterministicRenderer.setLevel(level);
+  bool isStillPlaying = deterministicRenderer.render(
+      bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample),
+      bufferToFill.numSamples, getWaveform());
+
+  copyFirstChannelToOthers(bufferToFill);
+
+  currentAmountIndex = deterministicRenderer.getCurrentNote();
+  if (!isStillPlaying) notesToPlay.clear();
+}
+
+Waveform MainComponent::getWaveform() {
+  switch (oscillatorId) {
+    case kSquare:
+      return Waveform::kSquare;
+    case kTriangle:
+      return Waveform::kTriangle;
+    case kSaw:
+      return Waveform::kSaw;
+    default:
+      return Waveform::kSine;
+  }
+}
+
+void MainComponent::copyFirstChannelToOthers(
+    const AudioSourceChannelInfo& bufferToFill) {
+  for (int channel = 1; channel < bufferToFill.buffer->getNumChannels();
+       channel++) {
+    bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample,
+                                  *bufferToFill.buffer, 0,
+                                  bufferToFill.startSample,
+                                  bufferToFill.numSamples);
+  }
+}
+
 bool MainComponent::decrementNoteDurations() {
   // Decrement sample
   notesToPlay.getReference(currentAmountIndex).second--;
@@ -522,6 +975,168 @@ bool MainComponent::decrementNoteDurations() {
   return false;
 }
 
+void MainComponent::sendMidiNotes(const AudioSourceChannelInfo& bufferToFill) {
+  if (midiOutput == nullptr) return;
+
+  // Events are timed from the start of this block, so the sender keeps them
+  // sample-accurate rather than block-quantized
+  auto blockStartTime = Time::getMillisecondCounterHiRes();
+  auto getEventTime = [&](int samplePosition) {
+    return blockStartTime + samplePosition * 1000.0 / srate;
+  };
+  auto velocity = static_cast<uint8>(jlimit(1, 127, roundToInt(level * 127)));
+
+  int samplePosition = 0;
+  while (samplePosition < bufferToFill.numSamples) {
+    auto& note = notesToPlay.getReference(currentAmountIndex);
+
+    // Start the current note if it hasn't been sent yet
+    if (lastMidiNote < 0) {
+      lastMidiNote = static_cast<int>(note.first);
+      midiNoteSender.pushNote(getEventTime(samplePosition), lastMidiNote,
+                              velocity);
+    }
+
+    int samplesToPlay =
+        jmin(note.second, bufferToFill.numSamples - samplePosition);
+    note.second -= samplesToPlay;
+    samplePosition += samplesToPlay;
+
+    // If entire note duration has been played, move on to next note
+    if (note.second == 0) {
+      midiNoteSender.pushNote(getEventTime(samplePosition), lastMidiNote, 0);
+      lastMidiNote = -1;
+      currentAmountIndex++;
+      if (currentAmountIndex >= notesToPlay.size()) {
+        notesToPlay.clear();
+        break;
+      }
+    }
+  }
+}
+
+void MainComponent::setMidiOutputEnabled(bool shouldBeEnabled) {
+  if (!shouldBeEnabled) {
+    midiOutputEnabled = false;
+    midiNoteSender.stop();
+    midiOutput.reset();
+    return;
+  }
+
+  // Prefer a virtual port that other apps can connect to, and fall back to
+  // the default device on platforms that can't create one (i.e. Windows)
+  midiOutput = MidiOutput::createNewDevice(kMidiOutputName);
+  if (midiOutput == nullptr) {
+    auto defaultDevice = MidiOutput::getDefaultDevice();
+    if (defaultDevice.identifier.isNotEmpty()) {
+      midiOutput = MidiOutput::openDevice(defaultDevice.identifier);
+    }
+  }
+
+  if (midiOutput == nullptr) {
+    midiOutButton.setToggleState(false, dontSendNotification);
+    midiOutputEnabled = false;
+    return;
+  }
+
+  midiNoteSender.start(*midiOutput);
+  midiOutputEnabled = true;
+}
+
+void MainComponent::loadSampleBank(const juce::File& file) {
+  auto bankFile = file;
+
+  // Convert a folder of samples into a bank next to them first
+  if (file.isDirectory()) {
+    Array<File> audioFiles;
+    for (const auto& entry : RangedDirectoryIterator(
+             file, false, "*.wav;*.aif;*.aiff;*.flac", File::findFiles)) {
+      audioFiles.add(entry.getFile());
+    }
+
+    bankFile =
+        file.getChildFile(file.getFileName()).withFileExtension("dsbank");
+    double bankSampleRate = srate > 0.0 ? srate : 44100.0;
+    if (!SampleBank::convertAudioFiles(audioFiles, bankFile, bankSampleRate)) {
+      AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Sampler",
+                                       "No samples could be converted from " +
+                                           file.getFullPathName());
+      return;
+    }
+  }
+
+  if (!sampleBank.load(bankFile)) {
+    AlertWindow::showMessageBoxAsync(
+        AlertWindow::WarningIcon, "Sampler",
+        bankFile.getFullPathName() + " isn't a valid sample bank");
+    return;
+  }
+
+  const auto& stats = sampleBank.getLastLoadStats();
+  juce::String message = "Mapped " +
+                         File::descriptionOfSizeInBytes(stats.mappedBytes) +
+                         " in " + juce::String(stats.loadTimeMs, 1) + " ms";
+  if (stats.residentBytesAfter >= 0) {
+    message << "\nResident memory: "
+            << File::descriptionOfSizeInBytes(stats.residentBytesBefore)
+            << " -> "
+            << File::descriptionOfSizeInBytes(stats.residentBytesAfter);
+  }
+  AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon, "Sampler", message);
+
+  oscillatorMenu.setSelectedId(kSampler);
+}
+
+void MainComponent::showAudioSettings() {
+  if (audioSettingsWindow != nullptr) {
+    audioSettingsWindow->toFront(true);
+    return;
+  }
+
+  DialogWindow::LaunchOptions options;
+  options.content.setOwned(new AudioSettingsComponent(audioSettings));
+  options.dialogTitle = "Audio settings";
+  options.dialogBackgroundColour =
+      getLookAndFeel().findColour(ResizableWindow::backgroundColourId);
+  options.escapeKeyTriggersCloseButton = true;
+  options.useNativeTitleBar = true;
+  options.resizable = false;
+  audioSettingsWindow = options.launchAsync();
+}
+
+void MainComponent::setAudioSettingsPlaying(bool playing) {
+  if (audioSettingsWindow == nullptr) return;
+  if (auto* content = dynamic_cast<AudioSettingsComponent*>(
+          audioSettingsWindow->getContentComponent())) {
+    content->setPlaying(playing);
+  }
+}
+
+void MainComponent::exportAllRegionsToMidi(const juce::File& directory) {
+  int numFailed = 0;
+  auto velocity = static_cast<uint8>(jlimit(1, 127, roundToInt(level * 127)));
+
+  const auto& regionNames = dataTable.getRegionNames();
+  for (int i = 0; i < regionNames.size(); i++) {
+    juce::String regionName(regionNames[i]);
+    auto notes = convertAmountsToNotes(getRegionAmounts(i));
+    auto file = directory.getChildFile(File::createLegalFileName(regionName))
+                    .withFileExtension("mid");
+
+    if (!MidiExporter::writeMidiFile(file, notes, playbackBpm, regionName,
+                                     velocity)) {
+      numFailed++;
+    }
+  }
+
+  if (numFailed > 0) {
+    AlertWindow::showMessageBoxAsync(
+        AlertWindow::WarningIcon, "MIDI export",
+        juce::String(numFailed) + " file(s) couldn't be written to " +
+            directory.getFullPathName());
+  }
+}
+
 float MainComponent::getRandomSample() {
   return random.nextFloat() * 2.0f - 1.0f;
 }
@@ -583,14 +1198,20 @@ double MainComponent::mapAmount(double low1, double high1, double low2,
 }
 
 juce::Array<std::pair<double, int>> MainComponent::convertAmountsToNotes(
-    const juce::Array<double>& amounts) {
+    const DataTable::Slice& amounts) {
+  TRACE_SCOPE("note conversion");
   juce::Array<std::pair<double, int>> arr;
   int noteDurationInSamples = std::ceil(srate / (playbackBpm / 60.0));
 
   for (double amount : amounts) {
+    // A constant series (such as a one-day range or an empty column) has no
+    // range to map from, so it stays on the lowest pitch
     double note =
-        mapAmount(minAmount, maxAmount, minMidiPitch, maxMidiPitch, amount);
-    double quantizedNote = quantizeNote(note);
+        maxAmount > minAmount
+            ? mapAmount(minAmount, maxAmount, minMidiPitch, maxMidiPitch,
+                        amount)
+            : minMidiPitch;
+    double quantizedNote = Scale::quantize(note, scaleId);
 
     arr.add({quantizedNote, noteDurationInSamples});
   }
@@ -598,59 +1219,120 @@ juce::Array<std::pair<double, int>> MainComponent::convertAmountsToNotes(
   return arr;
 }
 
-int MainComponent::quantizeNote(double amount) {
-  bool isQuantized = false;
-  int note = static_cast<int>(amount);
+DataTable::Slice MainComponent::getRegionAmounts() {
+  return getRegionAmounts(selectedRegionIndex);
+}
 
-  const juce::Array<int>* currentScale;
-  switch (scaleId) {
-    case kDiatonic:
-      currentScale = &kDiatonicPitches;
-      break;
-    case kPentatonic:
-      currentScale = &kPentatonicPitches;
-      break;
-    case kWholeTone:
-      currentScale = &kWholeTonePitches;
+DataTable::Slice MainComponent::getRegionAmounts(int regionIndex) {
+  TRACE_SCOPE("stats");
+  auto amounts = dataTable.getSlice(regionIndex, getSelectedRows());
+  updateAmountRange(amounts);
+  return amounts;
+}
+
+juce::Range<int> MainComponent::getSelectedRows() {
+  return dataTable.findRows(static_cast<int>(startDateSlider.getValue()),
+                            static_cast<int>(endDateSlider.getValue()));
+}
+
+DataTable::Slice MainComponent::getAggregateAmounts() {
+  TRACE_SCOPE("aggregate");
+  auto rows = getSelectedRows();
+
+  aggregateLeaders.clear();
+  switch (aggregateModeId) {
+    case kCountryTotal:
+      aggregateAmounts = regionAggregator.sum(
+          dataTable, RegionAggregator::getCountries(dataTable), rows);
       break;
-    default:
-      return note;
-  }
+    case kFastestGrowth: {
+      // Sonify the growth of whichever country is growing fastest each day.
+      // Countries without enough cases rank last, so a day is only left out
+      // when none of them has a base to measure growth against.
+      const double noBase = -std::numeric_limits<double>::infinity();
+      auto countries = RegionAggregator::getCountries(dataTable);
+      auto growth =
+          regionAggregator.windowGrowth(dataTable, countries, rows,
+                                        kGrowthWindowDays, kMinGrowthCases,
+                                        noBase);
+      aggregateLeaders = regionAggregator.topRegions(
+          growth, countries, rows.getLength(), 1);
+
+      std::vector<int> countryPositions(dataTable.getNumRegions(), -1);
+      for (int i = 0; i < countries.size(); i++) {
+        countryPositions[countries[i]] = i;
+      }
 
-  while (!isQuantized) {
-    int currentPitchClass = note % kNumPitchClasses;
-    for (int pitchClass : *currentScale) {
-      if (currentPitchClass == pitchClass) {
-        isQuantized = true;
-        break;
+      aggregateAmounts.assign(aggregateLeaders.size(), 0.0);
+      for (int i = 0; i < aggregateLeaders.size(); i++) {
+        if (aggregateLeaders[i] < 0) continue;
+        int position = countryPositions[aggregateLeaders[i]];
+        double leaderGrowth =
+            growth[static_cast<size_t>(position) * rows.getLength() + i];
+        if (leaderGrowth == noBase) {
+          aggregateLeaders[i] = -1;
+          continue;
+        }
+        aggregateAmounts[i] = leaderGrowth * 100.0;
       }
+      break;
     }
-    if (!isQuantized) {
-      note--;
+    case kSelectedRegionRank: {
+      // Rank the selected region among the countries, even if it isn't one
+      auto countries = RegionAggregator::getCountries(dataTable);
+      auto ranks = regionAggregator.rankOf(dataTable, countries,
+                                           selectedRegionIndex, rows);
+      bool isCountry = std::find(countries.begin(), countries.end(),
+                                 selectedRegionIndex) != countries.end();
+      numRankedRegions =
+          static_cast<int>(countries.size()) + (isCountry ? 0 : 1);
+
+      // Higher ranks play higher notes, so rank 0 (the largest) is inverted
+      aggregateAmounts.resize(rows.getLength());
+      for (int i = 0; i < rows.getLength(); i++) {
+        aggregateAmounts[i] = static_cast<double>(numRankedRegions - ranks[i]);
+      }
+      break;
     }
+    default:
+      return getRegionAmounts();
   }
 
-  return note;
+  DataTable::Slice amounts{aggregateAmounts.data(), rows.getStart(),
+                           static_cast<int>(aggregateAmounts.size())};
+  updateAmountRange(amounts);
+  return amounts;
 }
 
-juce::Array<double> MainComponent::getRegionAmounts() {
-  juce::Array<double> arr;
-  maxAmount = DBL_MIN;
-  minAmount = DBL_MAX;
-
-  for (int i = 1; i < rawData.size(); i++) {
-    std::string data = rawData[i][selectedRegionIndex + 1];
-    if (data.empty()) {
-      minAmount = 0.0;
-      arr.add(0.0);
-    } else {
-      double parsedData = std::stod(data);
-
-      if (parsedData < minAmount) minAmount = parsedData;
-      if (parsedData > maxAmount) maxAmount = parsedData;
+void MainComponent::updateAmountRange(const DataTable::Slice& amounts) {
+  if (amounts.isEmpty()) {
+    minAmount = 0.0;
+    maxAmount = 0.0;
+  } else {
+    auto range = FloatVectorOperations::findMinAndMax(amounts.values,
+                                                      amounts.size());
+    minAmount = range.getStart();
+    maxAmount = range.getEnd();
+  }
+}
 
-      arr.add(parsedData);
+juce::String MainComponent::describeAmount(int index) {
+  double amount = amountsToPlay[index];
+  switch (aggregateModeId) {
+    case kCountryTotal:
+      return juce::String(amount) + " cases";
+    case kFastestGrowth: {
+      int leader = index < aggregateLeaders.size() ? aggregateLeaders[index]
+                                                    : -1;
+      if (leader < 0) return "";
+      return juce::String(dataTable.getRegionNames()[leader]) + " +" +
+             juce::String(amount, 1) + "%";
     }
+    case kSelectedRegionRank:
+      return "Rank " +
+             juce::String(numRankedRegions - static_cast<int>(amount) + 1) +
+             " of " + juce::String(numRankedRegions);
+    default:
+      return juce::String(amount) + " cases";
   }
-  return arr;
 }
@@ -2,6 +2,24 @@
 
 #include <JuceHeader.h>
 
+#include "AnalyzerComponent.h"
+#include "AudioSettings.h"
+#include "AudioSettingsComponent.h"
+#include "ControlRateRenderer.h"
+#include "DataTable.h"
+#include "DeterministicRenderer.h"
+#include "MidiExporter.h"
+#include "MidiNoteSender.h"
+#include "RegionAggregator.h"
+#include "RegionIndex.h"
+#include "RegionPicker.h"
+#include "SampleBank.h"
+#include "Scale.h"
+#include "SnapshotHistory.h"
+#include "Tracer.h"
+#include "VisualizationFeed.h"
+#include "Waveform.h"
+
 //==============================================================================
 /*
     This component lives inside our window, and this is where you should put all
@@ -11,7 +29,8 @@ class MainComponent : public juce::AudioAppComponent,
                       public juce::ComboBox::Listener,
                       public juce::Slider::Listener,
                       public juce::Button::Listener,
-                      private juce::Thread {
+                      private juce::Thread,
+                      private juce::Timer {
  public:
   //==============================================================================
   MainComponent();
@@ -27,6 +46,11 @@ class MainComponent : public juce::AudioAppComponent,
   void paint(juce::Graphics& g) override;
   void resized() override;
   void run() override;
+  void timerCallback() override;
+#if DATA_SONIFICATION_TRACING
+  /** Ctrl/Cmd+Shift+T writes a Chrome trace of everything recorded so far */
+  bool keyPressed(const KeyPress& key) override;
+#endif
 
   //==============================================================================
   void sliderValueChanged(Slider* slider) override;
@@ -45,10 +69,55 @@ class MainComponent : public juce::AudioAppComponent,
                                int noteDuration);
   void inline generateSaw(const AudioSourceChannelInfo& bufferToFill,
                           int noteDuration);
+  void inline generateSampler(const AudioSourceChannelInfo& bufferToFill,
+                              int noteDuration);
+  /**
+   * Returns true if the data should be played as one gliding tone rather
+   * than as separate notes
+   */
+  bool isContinuous();
+  void startContinuous();
+  /**
+   * Switches the playback rate slider between BPM and continuous mode's
+   * points per second, whichever the next playback will use
+   */
+  void updatePlaybackRateSlider();
+  void generateContinuous(const AudioSourceChannelInfo& bufferToFill);
+  /**
+   * Returns true if notes should be rendered with integer arithmetic, so that
+   * every render of the same notes is bit-identical
+   */
+  bool isDeterministic();
+  void startDeterministic();
+  void generateDeterministic(const AudioSourceChannelInfo& bufferToFill);
+  /** Returns the renderers' waveform for the selected oscillator */
+  Waveform getWaveform();
+  /**
+   * Copies the block rendered into the first channel to the others, so every
+   * channel plays the same thing without rendering it again
+   */
+  static void copyFirstChannelToOthers(
+      const AudioSourceChannelInfo& bufferToFill);
   /**
    * Returns true if playback has ended, or false otherwise
    */
   bool decrementNoteDurations();
+  /**
+   * Advances the note timeline by one block, sending note on/off messages to
+   * the MIDI output instead of synthesizing audio
+   */
+  void sendMidiNotes(const AudioSourceChannelInfo& bufferToFill);
+  void setMidiOutputEnabled(bool shouldBeEnabled);
+  void exportAllRegionsToMidi(const juce::File& directory);
+  /**
+   * Loads a sample bank, or converts a folder of audio files into one and
+   * loads that, then reports how long it took
+   */
+  void loadSampleBank(const juce::File& file);
+  /** Opens the audio device, profile and latency settings in a dialog */
+  void showAudioSettings();
+  /** Locks or unlocks the audio settings dialog, if it's open */
+  void setAudioSettingsPlaying(bool playing);
   float inline getRandomSample();
   float inline getRandomSample(float amp);
   int convertFreqToMidi(double freq);
@@ -56,47 +125,91 @@ class MainComponent : public juce::AudioAppComponent,
   juce::Array<double> generateRandomAmounts(double start, double end,
                                             double range, int length);
   juce::Array<std::pair<double, int>> convertAmountsToNotes(
-      const juce::Array<double>& amounts);
+      const DataTable::Slice& amounts);
   double generateRandomAmount(double a, double b, double c, double d, double x);
   double mapAmount(double low1, double high1, double low2, double high2,
                    double amount);
-  int quantizeNote(double amount);
   juce::String getResultText(const URL& url);
-  juce::Array<double> getRegionAmounts();
+  /**
+   * Downloads and stores the latest version of the data, or reads the latest
+   * stored version if the download fails. Called on the loader thread.
+   */
+  DataTable fetchLatestTable();
+  /**
+   * Returns the selected date range of a region's values and updates
+   * minAmount and maxAmount to match
+   */
+  DataTable::Slice getRegionAmounts();
+  DataTable::Slice getRegionAmounts(int regionIndex);
+  juce::Range<int> getSelectedRows();
+  /**
+   * Replaces the data being sonified and the index of its regions, keeping
+   * the same region selected if there is one and resetting the date range.
+   * Must be called on the message thread while not playing.
+   */
+  void setDataTable(DataTable&& table, RegionIndex&& index);
+  void updateVersionMenu();
+  /**
+   * Computes the series for the selected aggregate mode over the selected
+   * date range and updates minAmount and maxAmount to match
+   */
+  DataTable::Slice getAggregateAmounts();
+  /**
+   * Sets minAmount and maxAmount to the range of the amounts, or to zero if
+   * there are none. A constant series leaves them equal.
+   */
+  void updateAmountRange(const DataTable::Slice& amounts);
+  juce::String describeAmount(int index);
 
  private:
   //==============================================================================
 
-  enum OscillatorId { kNoOscilator, kSine, kSquare, kTriangle, kSaw };
+  enum OscillatorId {
+    kNoOscilator,
+    kSine,
+    kSquare,
+    kTriangle,
+    kSaw,
+    kSampler
+  };
 
-  enum ScaleId { kNoScale, kChromatic, kDiatonic, kPentatonic, kWholeTone };
-
-  const juce::Array<int> kDiatonicPitches{0, 2, 4, 5, 7, 9, 11};
-  const juce::Array<int> kPentatonicPitches{0, 2, 4, 7, 9};
-  const juce::Array<int> kWholeTonePitches{0, 2, 4, 6, 8, 10};
-  const int kNumPitchClasses = 12;
+  enum AggregateModeId {
+    kNoAggregateMode,
+    kSelectedRegion,
+    kCountryTotal,
+    kFastestGrowth,
+    kSelectedRegionRank
+  };
 
   AudioSourcePlayer audioSourcePlayer;
+  AudioSettings audioSettings{deviceManager};
+  TextButton audioSettingsButton{"Audio..."};
+  Component::SafePointer<DialogWindow> audioSettingsWindow;
   double phase = 0.0;
   double srate = 0.0;
   double phaseDelta = 0.0;
   double currentFreq = 0.0;
   const double TwoPi{double_Pi * 2.0};
   juce::Array<double> midiToFreqTable;
-  juce::Array<double> amountsToPlay;
+  DataTable::Slice amountsToPlay;
   juce::Array<std::pair<double, int>> notesToPlay;
   int currentAmountIndex = 0;
   double maxAmount = DBL_MIN;
   double minAmount = DBL_MAX;
 
   Rectangle<int> graphArea;
+  bool wasPlaying = false;
+  const int kGraphFramesPerSecond = 30;
+
+  VisualizationFeed visualizationFeed;
+  AnalyzerComponent analyzer{visualizationFeed};
 
   Random random;
 
   DrawableButton playButton{"", juce::DrawableButton::ImageOnButtonBackground};
   Label playLabel{"playLabel", "Play data"};
 
-  ComboBox dataMenu;
+  RegionPicker regionPicker;
   Label dataLabel{"dataLabel", "New daily cases for: "};
   Label dateLabel{"dateLabel", ""};
   Label casesLabel{"casesLabel", ""};
@@ -105,9 +218,25 @@ class MainComponent : public juce::AudioAppComponent,
   Label oscillatorLabel{"oscillatorLabel", "Oscillator: "};
   OscillatorId oscillatorId{kNoOscilator};
 
+  TextButton loadSamplesButton{"Load samples..."};
+  SampleBank sampleBank;
+  SamplerVoice samplerVoice;
+  int samplerNoteIndex = -1;
+
+  ToggleButton continuousButton{"Continuous"};
+  ComboBox controlRateMenu;
+  bool continuousMode = false;
+  int controlInterval = ControlRateRenderer::kDefaultControlInterval;
+  ControlRateRenderer controlRateRenderer;
+  std::vector<double> continuousPitches;
+
+  ToggleButton deterministicButton{"Deterministic"};
+  bool deterministicMode = false;
+  DeterministicRenderer deterministicRenderer;
+
   ComboBox scaleMenu;
   Label scaleLabel{"scalelabel", "Scale: "};
-  ScaleId scaleId{kNoScale};
+  Scale::ScaleId scaleId{Scale::kNoScale};
 
   Slider levelSlider;
   Label levelLabel{"levelLabel", "Level: "};
@@ -134,11 +263,46 @@ class MainComponent : public juce::AudioAppComponent,
   const int kMinBpm = 0;
   const int kMaxBpm = 999;
   int playbackBpm = 200;
+  // Continuous mode glides through points far faster than notes can be told
+  // apart, so it has its own rate
+  const int kMinPointsPerSecond = 1;
+  const int kMaxPointsPerSecond = 2000;
+  int pointsPerSecond = 100;
 
   ToggleButton minMaxUnitButton{"Use MIDI pitch"};
+
+  TextButton exportMidiButton{"Export MIDI..."};
+  std::unique_ptr<FileChooser> fileChooser;
+
+  ToggleButton midiOutButton{"Send MIDI"};
+  std::unique_ptr<MidiOutput> midiOutput;
+  MidiNoteSender midiNoteSender;
+  bool midiOutputEnabled = false;
+  int lastMidiNote = -1;
+  const juce::String kMidiOutputName{"Data Sonification"};
   
-  std::vector<std::vector<std::string>> rawData;
-  std::vector<std::string> regionNames;
+  Slider startDateSlider;
+  Label startDateLabel{"startDateLabel", "From"};
+  Slider endDateSlider;
+  Label endDateLabel{"endDateLabel", "To"};
+
+  DataTable dataTable;
+
+  ComboBox versionMenu;
+  Label versionLabel{"versionLabel", "Version: "};
+  SnapshotHistory snapshotHistory{SnapshotHistory::getDefaultDirectory()};
+  /** The version for the loader thread to read instead of downloading, or -1 */
+  std::atomic<int> versionToLoad{-1};
+
+  ComboBox aggregateMenu;
+  Label aggregateLabel{"aggregateLabel", "Mode: "};
+  AggregateModeId aggregateModeId{kSelectedRegion};
+  RegionAggregator regionAggregator;
+  std::vector<double> aggregateAmounts;
+  std::vector<int> aggregateLeaders;
+  int numRankedRegions = 0;
+  const int kGrowthWindowDays = 7;
+  const double kMinGrowthCases = 100.0;
   int selectedRegionIndex = 0;
 
   Font textFont{"Arial", 15.0f, Font::FontStyleFlags::plain};
@@ -0,0 +1,44 @@
+#include "MidiExporter.h"
+
+juce::MidiMessageSequence MidiExporter::createSequence(
+    const juce::Array<std::pair<double, int>>& notes, int bpm,
+    const juce::String& trackName, juce::uint8 velocity) {
+  juce::MidiMessageSequence sequence;
+
+  // A BPM of zero would mean an infinitely long beat
+  double microsecondsPerQuarterNote = 60000000.0 / juce::jmax(1, bpm);
+  sequence.addEvent(juce::MidiMessage::textMetaEvent(3, trackName), 0.0);
+  sequence.addEvent(juce::MidiMessage::tempoMetaEvent(
+                        juce::roundToInt(microsecondsPerQuarterNote)),
+                    0.0);
+
+  double tick = 0.0;
+  for (const auto& note : notes) {
+    int midiNote = juce::jlimit(0, 127, static_cast<int>(note.first));
+    sequence.addEvent(
+        juce::MidiMessage::noteOn(kMidiChannel, midiNote, velocity), tick);
+    // Events with equal timestamps keep their insertion order, so this note
+    // off always lands before the next note on
+    sequence.addEvent(juce::MidiMessage::noteOff(kMidiChannel, midiNote),
+                      tick + kTicksPerQuarterNote);
+    tick += kTicksPerQuarterNote;
+  }
+
+  sequence.addEvent(juce::MidiMessage::endOfTrack(), tick);
+  sequence.updateMatchedPairs();
+  return sequence;
+}
+
+bool MidiExporter::writeMidiFile(
+    const juce::File& file, const juce::Array<std::pair<double, int>>& notes,
+    int bpm, const juce::String& trackName, juce::uint8 velocity) {
+  juce::MidiFile midiFile;
+  midiFile.setTicksPerQuarterNote(kTicksPerQuarterNote);
+  midiFile.addTrack(createSequence(notes, bpm, trackName, velocity));
+
+  file.deleteFile();
+  juce::FileOutputStream stream(file);
+  if (stream.failedToOpen()) return false;
+
+  return midiFile.writeTo(stream, 1);
+}
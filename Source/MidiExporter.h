@@ -0,0 +1,33 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Converts the note timelines produced by MainComponent into Standard MIDI
+    Files. Every data point becomes a single beat at the chosen BPM, so a file
+    plays back exactly like the app's own oscillators would.
+*/
+class MidiExporter {
+ public:
+  static constexpr int kTicksPerQuarterNote = 960;
+  static constexpr int kMidiChannel = 1;
+
+  /**
+   * Builds a single track from (MIDI note, duration) pairs. Durations are
+   * ignored in favour of one beat per note, since they are measured in samples
+   * at the current device sample rate.
+   */
+  static juce::MidiMessageSequence createSequence(
+      const juce::Array<std::pair<double, int>>& notes, int bpm,
+      const juce::String& trackName, juce::uint8 velocity = 100);
+
+  /**
+   * Writes the notes as a type 1 Standard MIDI File, replacing any existing
+   * file. Returns false if the file couldn't be written.
+   */
+  static bool writeMidiFile(const juce::File& file,
+                            const juce::Array<std::pair<double, int>>& notes,
+                            int bpm, const juce::String& trackName,
+                            juce::uint8 velocity = 100);
+};
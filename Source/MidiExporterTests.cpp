@@ -0,0 +1,71 @@
+#include <JuceHeader.h>
+
+#include "MidiExporter.h"
+
+//==============================================================================
+/* Writes a file with MidiExporter and checks what MidiFile reads back */
+class MidiExporterTests : public juce::UnitTest {
+ public:
+  MidiExporterTests() : juce::UnitTest("MidiExporter", "DataSonification") {}
+
+  void runTest() override {
+    beginTest("A written file reads back with its tempo and notes");
+
+    // The repeated pitch checks note off ordering, and 200 must be clamped
+    juce::Array<std::pair<double, int>> notes{
+        {60.0, 100}, {60.7, 100}, {64.0, 100}, {200.0, 100}};
+    const int expectedPitches[] = {60, 60, 64, 127};
+    const int bpm = 90;
+
+    auto file = juce::File::createTempFile(".mid");
+    expect(MidiExporter::writeMidiFile(file, notes, bpm, "Test"));
+
+    juce::MidiFile midiFile;
+    {
+      juce::FileInputStream stream(file);
+      expect(stream.openedOk() && midiFile.readFrom(stream));
+    }
+    file.deleteFile();
+
+    expectEquals(static_cast<int>(midiFile.getTimeFormat()),
+                 MidiExporter::kTicksPerQuarterNote);
+    expectEquals(midiFile.getNumTracks(), 1);
+    if (midiFile.getNumTracks() != 1) return;
+
+    juce::MidiMessageSequence tempoEvents;
+    midiFile.findAllTempoEvents(tempoEvents);
+    expectEquals(tempoEvents.getNumEvents(), 1);
+    if (tempoEvents.getNumEvents() == 1) {
+      expectWithinAbsoluteError(
+          tempoEvents.getEventPointer(0)
+              ->message.getTempoSecondsPerQuarterNote(),
+          60.0 / bpm, 1.0e-6);
+    }
+
+    // Every note must be released before the next one starts, even when
+    // both happen at the same tick
+    const auto& track = *midiFile.getTrack(0);
+    int numNotes = 0;
+    int numSounding = 0;
+    for (int i = 0; i < track.getNumEvents(); i++) {
+      const auto& message = track.getEventPointer(i)->message;
+      if (message.isNoteOn()) {
+        expectEquals(numSounding, 0, "A note on came before the note off");
+        if (numNotes < notes.size()) {
+          expectEquals(message.getNoteNumber(), expectedPitches[numNotes]);
+          expectEquals(message.getTimeStamp(),
+                       static_cast<double>(numNotes *
+                                           MidiExporter::kTicksPerQuarterNote));
+        }
+        numNotes++;
+        numSounding++;
+      } else if (message.isNoteOff()) {
+        numSounding--;
+      }
+    }
+    expectEquals(numNotes, notes.size());
+    expectEquals(numSounding, 0);
+  }
+};
+
+static MidiExporterTests midiExporterTests;
@@ -0,0 +1,71 @@
+#include "MidiNoteSender.h"
+
+#include "MidiExporter.h"
+#include "Tracer.h"
+
+MidiNoteSender::MidiNoteSender() : Thread("MIDI Output"), events(kCapacity) {}
+
+MidiNoteSender::~MidiNoteSender() { stop(); }
+
+void MidiNoteSender::start(juce::MidiOutput& newOutput) {
+  stop();
+  output = &newOutput;
+  startThread(9);
+}
+
+void MidiNoteSender::stop() {
+  stopThread(kStopTimeoutMs);
+  fifo.reset();
+  if (output != nullptr) {
+    output->sendMessageNow(
+        juce::MidiMessage::allNotesOff(MidiExporter::kMidiChannel));
+    output = nullptr;
+  }
+}
+
+void MidiNoteSender::clear() {
+  if (auto* currentOutput = output) start(*currentOutput);
+}
+
+void MidiNoteSender::pushNote(double time, int note,
+                              juce::uint8 velocity) noexcept {
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(1, start1, size1, start2, size2);
+  if (size1 == 0) return;
+  events[start1] = {time, note, velocity};
+  fifo.finishedWrite(1);
+}
+
+void MidiNoteSender::run() {
+  TRACE_THREAD_NAME("MIDI");
+
+  while (!threadShouldExit()) {
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(1, start1, size1, start2, size2);
+    if (size1 == 0) {
+      // The audio thread can't wake this one without taking a lock, so poll
+      wait(kIdleWaitMs);
+      continue;
+    }
+
+    // Sleep in short steps until the event is due, so stopping stays quick
+    const auto& event = events[start1];
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    if (event.time > now + kMaxWaitMs) {
+      wait(kMaxWaitMs);
+      continue;
+    }
+    if (event.time > now) {
+      juce::Time::waitForMillisecondCounter(
+          static_cast<juce::uint32>(event.time));
+    }
+
+    output->sendMessageNow(
+        event.velocity > 0
+            ? juce::MidiMessage::noteOn(MidiExporter::kMidiChannel,
+                                        event.note, event.velocity)
+            : juce::MidiMessage::noteOff(MidiExporter::kMidiChannel,
+                                         event.note));
+    fifo.finishedRead(1);
+  }
+}
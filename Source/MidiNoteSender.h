@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Sends notes played on the audio thread to a MidiOutput without allocating
+    or locking there. The audio thread pushes timestamped note events into a
+    preallocated single-producer, single-consumer ring buffer, and a
+    background thread waits for each event's time and sends it. If the buffer
+    is full, the newest events are dropped.
+*/
+class MidiNoteSender : private juce::Thread {
+ public:
+  static constexpr int kCapacity = 1 << 12;
+
+  MidiNoteSender();
+  ~MidiNoteSender() override;
+
+  /** Starts sending to the output, which must stay open until stop() */
+  void start(juce::MidiOutput& output);
+
+  /**
+   * Stops sending, drops any events that haven't been sent yet and silences
+   * the output. Only safe while the audio thread isn't pushing.
+   */
+  void stop();
+
+  /** Drops unsent events and silences the output, then carries on sending */
+  void clear();
+
+  /**
+   * Audio thread only. Queues a note on, or a note off if velocity is 0, to
+   * be sent at a time given by Time::getMillisecondCounterHiRes().
+   */
+  void pushNote(double time, int note, juce::uint8 velocity) noexcept;
+
+ private:
+  /** The longest the thread sleeps before checking whether to exit */
+  static constexpr int kMaxWaitMs = 20;
+  static constexpr int kIdleWaitMs = 1;
+  static constexpr int kStopTimeoutMs = 1000;
+
+  struct NoteEvent {
+    double time;
+    int note;
+    juce::uint8 velocity;
+  };
+
+  void run() override;
+
+  juce::AbstractFifo fifo{kCapacity};
+  std::vector<NoteEvent> events;
+  juce::MidiOutput* output = nullptr;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiNoteSender)
+};
@@ -0,0 +1,488 @@
+#include "RegionAggregator.h"
+
+#include <array>
+#include <mutex>
+#include <numeric>
+
+namespace {
+/** How many rows are handled together by queries that read across columns */
+const int kTileRows = 16;
+/** rank() handles more rows at once, since it sorts each row in place */
+const int kRankTileRows = 64;
+const int kRegionBlockSize = 64;
+
+/**
+ * Maps a value to a key whose unsigned order is the value's descending
+ * order, so an ascending radix sort of the keys ranks the largest value first
+ */
+juce::uint64 toDescendingKey(double value) {
+  // -0 and +0 are equal, so they must share a key
+  if (value == 0.0) value = 0.0;
+
+  juce::uint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  auto ascendingKey = (bits >> 63) != 0 ? ~bits : bits | (1ull << 63);
+  return ~ascendingKey;
+}
+
+/** True for values that convert to an int64 and back unchanged */
+bool isWholeNumber(double value) {
+  return std::abs(value) < 9007199254740992.0 &&
+         static_cast<double>(static_cast<juce::int64>(value)) == value;
+}
+
+/** The radix sort handles at most this many bits of the key per pass */
+const int kMaxRadixBits = 11;
+
+/**
+ * Sorts by the bits of getKey(entry) from firstBit up, with an LSD radix sort
+ * that's stable, so equal keys keep their order. Only the bits that differ
+ * between keys are sorted by, split evenly between as few passes as possible
+ * so that the buckets stay small.
+ */
+template <typename Entry, typename GetKey>
+void radixSort(std::vector<Entry>& entries, std::vector<Entry>& scratch,
+               std::vector<int>& counts, int firstBit, GetKey getKey) {
+  juce::uint64 anyBits = 0;
+  juce::uint64 allBits = ~juce::uint64(0);
+  for (const auto& entry : entries) {
+    anyBits |= getKey(entry);
+    allBits &= getKey(entry);
+  }
+  auto differingBits = (anyBits ^ allBits) >> firstBit << firstBit;
+  if (differingBits == 0) return;
+
+  int lowestBit = firstBit;
+  while (((differingBits >> lowestBit) & 1) == 0) lowestBit++;
+  int highestBit = 63;
+  while (((differingBits >> highestBit) & 1) == 0) highestBit--;
+  int numBits = highestBit - lowestBit + 1;
+  int numPasses = (numBits + kMaxRadixBits - 1) / kMaxRadixBits;
+  int digitBits = (numBits + numPasses - 1) / numPasses;
+  int radixSize = 1 << digitBits;
+  auto digitMask = static_cast<juce::uint64>(radixSize - 1);
+
+  // Count every pass's digits in one read of the keys
+  counts.assign(static_cast<size_t>(numPasses) * radixSize, 0);
+  for (const auto& entry : entries) {
+    auto key = getKey(entry) >> lowestBit;
+    for (int pass = 0; pass < numPasses; pass++) {
+      counts[pass * radixSize + ((key >> (pass * digitBits)) & digitMask)]++;
+    }
+  }
+
+  for (int pass = 0; pass < numPasses; pass++) {
+    int* passCounts = counts.data() + pass * radixSize;
+    int position = 0;
+    for (int digit = 0; digit < radixSize; digit++) {
+      int bucketSize = passCounts[digit];
+      passCounts[digit] = position;
+      position += bucketSize;
+    }
+    int shift = lowestBit + pass * digitBits;
+    for (const auto& entry : entries) {
+      auto digit = (getKey(entry) >> shift) & digitMask;
+      scratch[passCounts[digit]++] = entry;
+    }
+    entries.swap(scratch);
+  }
+}
+}  // namespace
+
+RegionAggregator::RegionAggregator(int numThreads)
+    : threadPool(juce::jmax(1, numThreads - 1)),
+      numWorkers(juce::jmax(0, numThreads - 1)) {}
+
+std::vector<double> RegionAggregator::sum(const DataTable& table,
+                                          const std::vector<int>& regions,
+                                          juce::Range<int> rows) {
+  rows = rows.getIntersectionWith({0, table.getNumRows()});
+  std::vector<double> total(rows.getLength(), 0.0);
+  if (total.empty()) return total;
+
+  // Each chunk of regions sums into its own buffer, which is then added to
+  // the total under a lock once per chunk
+  std::mutex totalLock;
+  parallelFor(static_cast<int>(regions.size()), [&](int begin, int end) {
+    std::vector<double> partial(total.size(), 0.0);
+    for (int i = begin; i < end; i++) {
+      juce::FloatVectorOperations::add(
+          partial.data(), table.getColumn(regions[i]) + rows.getStart(),
+          rows.getLength());
+    }
+
+    std::lock_guard<std::mutex> lock(totalLock);
+    juce::FloatVectorOperations::add(total.data(), partial.data(),
+                                     rows.getLength());
+  });
+
+  return total;
+}
+
+std::vector<int> RegionAggregator::rank(const DataTable& table,
+                                        const std::vector<int>& regions,
+                                        juce::Range<int> rows) {
+  rows = rows.getIntersectionWith({0, table.getNumRows()});
+  int numRows = rows.getLength();
+  int numRegions = static_cast<int>(regions.size());
+  std::vector<int> ranks(static_cast<size_t>(numRows) * numRegions, 0);
+  if (ranks.empty()) return ranks;
+
+  // Each region's key is packed above its index in one word, so that sorting
+  // the words sorts by key while the stable sort keeps ties in index order
+  int indexBits = 0;
+  while ((1 << indexBits) < numRegions) indexBits++;
+  auto indexMask = (juce::uint64(1) << indexBits) - 1;
+
+  parallelFor(numRows, [&](int begin, int end) {
+    std::vector<double> tile(static_cast<size_t>(kRankTileRows) * numRegions);
+    std::vector<int> tileRanks(tile.size());
+    std::array<double, kRankTileRows> minValues, maxValues;
+    std::array<bool, kRankTileRows> areWhole;
+    std::vector<juce::uint64> packed(numRegions);
+    std::vector<juce::uint64> packedScratch(numRegions);
+    std::vector<std::pair<juce::uint64, int>> order;
+    std::vector<std::pair<juce::uint64, int>> scratch;
+    std::vector<int> counts;
+
+    auto rankPacked = [&](int* rowRanks) {
+      radixSort(packed, packedScratch, counts, indexBits,
+                [](juce::uint64 entry) { return entry; });
+      for (int position = 0; position < numRegions; position++) {
+        rowRanks[packed[position] & indexMask] = position;
+      }
+    };
+
+    // Rows are ranked a tile at a time. The tile is transposed in blocks of
+    // regions, so every column is read (and written) in runs of a few cache
+    // lines rather than one value per row.
+    for (int tileStart = begin; tileStart < end; tileStart += kRankTileRows) {
+      int tileLength = juce::jmin(kRankTileRows, end - tileStart);
+      minValues.fill(std::numeric_limits<double>::infinity());
+      maxValues.fill(-std::numeric_limits<double>::infinity());
+      areWhole.fill(true);
+
+      for (int blockStart = 0; blockStart < numRegions;
+           blockStart += kRegionBlockSize) {
+        int blockEnd = juce::jmin(numRegions, blockStart + kRegionBlockSize);
+        const double* columns[kRegionBlockSize];
+        for (int i = blockStart; i < blockEnd; i++) {
+          columns[i - blockStart] =
+              table.getColumn(regions[i]) + rows.getStart() + tileStart;
+        }
+
+        for (int row = 0; row < tileLength; row++) {
+          double* rowValues =
+              tile.data() + static_cast<size_t>(row) * numRegions;
+          for (int i = blockStart; i < blockEnd; i++) {
+            double value = columns[i - blockStart][row];
+            rowValues[i] = value;
+            minValues[row] = juce::jmin(minValues[row], value);
+            maxValues[row] = juce::jmax(maxValues[row], value);
+            areWhole[row] = areWhole[row] && isWholeNumber(value);
+          }
+        }
+      }
+
+      for (int row = 0; row < tileLength; row++) {
+        auto offset = static_cast<size_t>(row) * numRegions;
+        const double* rowValues = tile.data() + offset;
+        int* rowRanks = tileRanks.data() + offset;
+
+        // Whole numbers, like case counts, are keyed by how far below the
+        // largest they are, which takes far fewer bits (and so fewer passes
+        // of the sort) than their doubles
+        int keyBits = 64;
+        if (areWhole[row]) {
+          auto range = static_cast<juce::uint64>(
+              static_cast<juce::int64>(maxValues[row]) -
+              static_cast<juce::int64>(minValues[row]));
+          keyBits = 0;
+          while (keyBits < 64 && (range >> keyBits) != 0) keyBits++;
+        }
+
+        if (keyBits + indexBits <= 64) {
+          auto largest = static_cast<juce::int64>(maxValues[row]);
+          for (int i = 0; i < numRegions; i++) {
+            auto key = static_cast<juce::uint64>(
+                largest - static_cast<juce::int64>(rowValues[i]));
+            packed[i] = key << indexBits | static_cast<juce::uint64>(i);
+          }
+          rankPacked(rowRanks);
+          continue;
+        }
+
+        // Anything else is keyed by its bits. Keys whose lowest bits are all
+        // the same can give them up for the index, and otherwise are sorted
+        // alongside it.
+        juce::uint64 anyBits = 0;
+        juce::uint64 allBits = ~juce::uint64(0);
+        for (int i = 0; i < numRegions; i++) {
+          packed[i] = toDescendingKey(rowValues[i]);
+          anyBits |= packed[i];
+          allBits &= packed[i];
+        }
+        int lowestBit = 0;
+        auto differingBits = anyBits & ~allBits;
+        while (lowestBit < 64 && ((differingBits >> lowestBit) & 1) == 0) {
+          lowestBit++;
+        }
+
+        if (lowestBit >= indexBits) {
+          for (int i = 0; i < numRegions; i++) {
+            packed[i] = (lowestBit == 64 ? 0 : packed[i] >> lowestBit)
+                            << indexBits |
+                        static_cast<juce::uint64>(i);
+          }
+          rankPacked(rowRanks);
+        } else {
+          order.resize(numRegions);
+          scratch.resize(numRegions);
+          for (int i = 0; i < numRegions; i++) order[i] = {packed[i], i};
+          radixSort(order, scratch, counts, 0,
+                    [](const std::pair<juce::uint64, int>& entry) {
+                      return entry.first;
+                    });
+          for (int position = 0; position < numRegions; position++) {
+            rowRanks[order[position].second] = position;
+          }
+        }
+      }
+
+      for (int blockStart = 0; blockStart < numRegions;
+           blockStart += kRegionBlockSize) {
+        int blockEnd = juce::jmin(numRegions, blockStart + kRegionBlockSize);
+        for (int row = 0; row < tileLength; row++) {
+          const int* rowRanks =
+              tileRanks.data() + static_cast<size_t>(row) * numRegions;
+          for (int i = blockStart; i < blockEnd; i++) {
+            ranks[static_cast<size_t>(i) * numRows + tileStart + row] =
+                rowRanks[i];
+          }
+        }
+      }
+    }
+  });
+
+  return ranks;
+}
+
+std::vector<int> RegionAggregator::rankOf(const DataTable& table,
+                                          const std::vector<int>& regions,
+                                          int region, juce::Range<int> rows) {
+  rows = rows.getIntersectionWith({0, table.getNumRows()});
+  std::vector<int> ranks(rows.getLength(), 0);
+  if (ranks.empty()) return ranks;
+
+  const double* target = table.getColumn(region) + rows.getStart();
+  auto position = static_cast<int>(
+      std::find(regions.begin(), regions.end(), region) - regions.begin());
+
+  // Regions ahead of it are the larger ones, and the equal ones listed before
+  // it, since rank() breaks ties by position
+  std::mutex ranksLock;
+  parallelFor(static_cast<int>(regions.size()), [&](int begin, int end) {
+    std::vector<int> partial(ranks.size(), 0);
+    for (int i = begin; i < end; i++) {
+      const double* column = table.getColumn(regions[i]) + rows.getStart();
+      bool isListedBefore = i < position;
+      for (int row = 0; row < rows.getLength(); row++) {
+        partial[row] += column[row] > target[row] ||
+                        (isListedBefore && column[row] == target[row]);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(ranksLock);
+    for (size_t row = 0; row < ranks.size(); row++) ranks[row] += partial[row];
+  });
+
+  return ranks;
+}
+
+std::vector<double> RegionAggregator::windowSum(
+    const DataTable& table, const std::vector<int>& regions,
+    juce::Range<int> rows, int windowLength) {
+  rows = rows.getIntersectionWith({0, table.getNumRows()});
+  int numRows = rows.getLength();
+  windowLength = juce::jmax(1, windowLength);
+  std::vector<double> sums(static_cast<size_t>(numRows) * regions.size());
+
+  int firstRow = juce::jmax(0, rows.getStart() - windowLength);
+  parallelFor(static_cast<int>(regions.size()), [&](int begin, int end) {
+    std::vector<double> prefix(rows.getEnd() - firstRow + 1);
+
+    for (int i = begin; i < end; i++) {
+      const double* column = table.getColumn(regions[i]);
+      prefix[0] = 0.0;
+      for (int row = firstRow; row < rows.getEnd(); row++) {
+        prefix[row - firstRow + 1] = prefix[row - firstRow] + column[row];
+      }
+
+      double* result = sums.data() + static_cast<size_t>(i) * numRows;
+      for (int row = rows.getStart(); row < rows.getEnd(); row++) {
+        int windowStart = juce::jmax(firstRow, row + 1 - windowLength);
+        result[row - rows.getStart()] =
+            prefix[row - firstRow + 1] - prefix[windowStart - firstRow];
+      }
+    }
+  });
+
+  return sums;
+}
+
+std::vector<double> RegionAggregator::windowGrowth(
+    const DataTable& table, const std::vector<int>& regions,
+    juce::Range<int> rows, int windowLength, double minimumBase,
+    double noBaseGrowth) {
+  rows = rows.getIntersectionWith({0, table.getNumRows()});
+  int numRows = rows.getLength();
+  windowLength = juce::jmax(1, windowLength);
+  std::vector<double> growth(static_cast<size_t>(numRows) * regions.size());
+
+  int firstRow = juce::jmax(0, rows.getStart() - 2 * windowLength);
+  parallelFor(static_cast<int>(regions.size()), [&](int begin, int end) {
+    std::vector<double> prefix(rows.getEnd() - firstRow + 1);
+
+    for (int i = begin; i < end; i++) {
+      const double* column = table.getColumn(regions[i]);
+      prefix[0] = 0.0;
+      for (int row = firstRow; row < rows.getEnd(); row++) {
+        prefix[row - firstRow + 1] = prefix[row - firstRow] + column[row];
+      }
+
+      double* result = growth.data() + static_cast<size_t>(i) * numRows;
+      for (int row = rows.getStart(); row < rows.getEnd(); row++) {
+        int currentStart = juce::jmax(firstRow, row + 1 - windowLength);
+        int previousStart = juce::jmax(firstRow, row + 1 - 2 * windowLength);
+        double current =
+            prefix[row - firstRow + 1] - prefix[currentStart - firstRow];
+        double previous =
+            prefix[currentStart - firstRow] - prefix[previousStart - firstRow];
+
+        bool hasBase = previous > 0.0 && previous >= minimumBase;
+        result[row - rows.getStart()] =
+            hasBase ? current / previous - 1.0 : noBaseGrowth;
+      }
+    }
+  });
+
+  return growth;
+}
+
+std::vector<int> RegionAggregator::topRegions(const DataTable& table,
+                                              const std::vector<int>& regions,
+                                              juce::Range<int> rows,
+                                              Metric metric, int windowLength,
+                                              int k, double minimumBase) {
+  rows = rows.getIntersectionWith({0, table.getNumRows()});
+  auto values =
+      metric == kWindowGrowth
+          ? windowGrowth(table, regions, rows, windowLength, minimumBase)
+          : windowSum(table, regions, rows, windowLength);
+
+  return topRegions(values, regions, rows.getLength(), k);
+}
+
+std::vector<int> RegionAggregator::topRegions(const std::vector<double>& values,
+                                              const std::vector<int>& regions,
+                                              int numRows, int k) {
+  int numRegions = static_cast<int>(regions.size());
+  k = juce::jmax(0, k);
+  jassert(values.size() == static_cast<size_t>(numRows) * regions.size());
+
+  // Rows with fewer than k regions are padded with -1
+  std::vector<int> leaders(static_cast<size_t>(numRows) * k, -1);
+  int numLeaders = juce::jmin(k, numRegions);
+
+  parallelFor(numRows, [&](int begin, int end) {
+    std::vector<double> tile(static_cast<size_t>(kTileRows) * numRegions);
+    std::vector<int> order(numRegions);
+
+    // Like rank(), read a short run of each region's values at a time
+    for (int tileStart = begin; tileStart < end; tileStart += kTileRows) {
+      int tileLength = juce::jmin(kTileRows, end - tileStart);
+      for (int i = 0; i < numRegions; i++) {
+        const double* regionValues =
+            values.data() + static_cast<size_t>(i) * numRows + tileStart;
+        for (int row = 0; row < tileLength; row++) {
+          tile[static_cast<size_t>(row) * numRegions + i] = regionValues[row];
+        }
+      }
+
+      for (int row = 0; row < tileLength; row++) {
+        const double* rowValues =
+            tile.data() + static_cast<size_t>(row) * numRegions;
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + numLeaders,
+                          order.end(), [rowValues](int a, int b) {
+                            return rowValues[a] > rowValues[b] ||
+                                   (rowValues[a] == rowValues[b] && a < b);
+                          });
+
+        auto* rowLeaders =
+            leaders.data() + static_cast<size_t>(tileStart + row) * k;
+        for (int i = 0; i < numLeaders; i++) {
+          rowLeaders[i] = regions[order[i]];
+        }
+      }
+    }
+  });
+
+  return leaders;
+}
+
+bool RegionAggregator::isAggregateRegion(const std::string& name) {
+  static const std::vector<std::string> kAggregateNames{
+      "Africa",
+      "Asia",
+      "Europe",
+      "European Union",
+      "North America",
+      "Oceania",
+      "South America",
+      "High income",
+      "Low income",
+      "Lower middle income",
+      "Upper middle income",
+      "International"};
+
+  return juce::String(name).startsWith("World") ||
+         std::find(kAggregateNames.begin(), kAggregateNames.end(), name) !=
+             kAggregateNames.end();
+}
+
+std::vector<int> RegionAggregator::getCountries(const DataTable& table) {
+  std::vector<int> countries;
+  const auto& names = table.getRegionNames();
+  for (int i = 0; i < names.size(); i++) {
+    if (!isAggregateRegion(names[i])) countries.push_back(i);
+  }
+  return countries;
+}
+
+void RegionAggregator::parallelFor(
+    int numItems, const std::function<void(int, int)>& function) {
+  if (numItems <= 0) return;
+
+  int numChunks = juce::jmin(numWorkers + 1, numItems);
+  int chunkSize = (numItems + numChunks - 1) / numChunks;
+
+  std::atomic<int> numRemaining{numChunks - 1};
+  juce::WaitableEvent finished;
+
+  for (int chunk = 1; chunk < numChunks; chunk++) {
+    int begin = juce::jmin(numItems, chunk * chunkSize);
+    int end = juce::jmin(numItems, begin + chunkSize);
+
+    std::function<juce::ThreadPoolJob::JobStatus()> job = [&, begin, end] {
+      if (begin < end) function(begin, end);
+      if (--numRemaining == 0) finished.signal();
+      return juce::ThreadPoolJob::jobHasFinished;
+    };
+    threadPool.addJob(job);
+  }
+
+  // The calling thread takes the first chunk rather than sitting idle
+  function(0, juce::jmin(numItems, chunkSize));
+  if (numChunks > 1) finished.wait();
+}
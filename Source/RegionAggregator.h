@@ -0,0 +1,105 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "DataTable.h"
+
+//==============================================================================
+/*
+    Answers whole-table queries (totals, ranks, growth rates and leaders) over
+    a DataTable. Work is split across a thread pool by region or by date, and
+    the inner loops use JUCE's vectorised FloatVectorOperations where possible.
+
+    Per-region results are laid out like DataTable columns: one run of
+    rows.getLength() values for each entry of the regions argument.
+*/
+class RegionAggregator {
+ public:
+  enum Metric { kWindowSum, kWindowGrowth };
+
+  explicit RegionAggregator(
+      int numThreads = juce::SystemStats::getNumCpus());
+
+  /** Returns the total of all the given regions for each row */
+  std::vector<double> sum(const DataTable& table,
+                          const std::vector<int>& regions,
+                          juce::Range<int> rows);
+
+  /**
+   * Returns the rank of each region among the given regions for each row,
+   * where 0 is the largest value
+   */
+  std::vector<int> rank(const DataTable& table, const std::vector<int>& regions,
+                        juce::Range<int> rows);
+
+  /**
+   * Returns the rank that rank() would give one region (a table index) at
+   * each row, by counting the regions ahead of it instead of sorting them. A
+   * region that isn't one of the given regions is ranked as if it were added
+   * after them.
+   */
+  std::vector<int> rankOf(const DataTable& table,
+                          const std::vector<int>& regions, int region,
+                          juce::Range<int> rows);
+
+  /**
+   * Returns the sum of each region's last windowLength values at every row.
+   * Windows may reach back before the first selected row.
+   */
+  std::vector<double> windowSum(const DataTable& table,
+                                const std::vector<int>& regions,
+                                juce::Range<int> rows, int windowLength);
+
+  /**
+   * Returns each region's growth from the previous window to the current one
+   * at every row (0.5 means +50%). Growth is noBaseGrowth wherever the
+   * previous window totals less than minimumBase, so tiny counts don't swamp
+   * the result.
+   */
+  std::vector<double> windowGrowth(const DataTable& table,
+                                   const std::vector<int>& regions,
+                                   juce::Range<int> rows, int windowLength,
+                                   double minimumBase = 0.0,
+                                   double noBaseGrowth = 0.0);
+
+  /**
+   * Returns the table indices of the k regions with the largest metric for
+   * each row, k per row, largest first
+   */
+  std::vector<int> topRegions(const DataTable& table,
+                              const std::vector<int>& regions,
+                              juce::Range<int> rows, Metric metric,
+                              int windowLength, int k,
+                              double minimumBase = 0.0);
+
+  /**
+   * Same as above, but ranks values that have already been computed with one
+   * of the per-region queries
+   */
+  std::vector<int> topRegions(const std::vector<double>& values,
+                              const std::vector<int>& regions, int numRows,
+                              int k);
+
+  /**
+   * Returns true for OWID's continent, income group and world columns, which
+   * would be counted twice if they were summed alongside the countries
+   */
+  static bool isAggregateRegion(const std::string& name);
+
+  /** Returns the indices of every region that isn't an aggregate */
+  static std::vector<int> getCountries(const DataTable& table);
+
+ private:
+  /**
+   * Calls function(begin, end) over chunks of [0, numItems) on the pool and
+   * the calling thread, returning once every chunk is done
+   */
+  void parallelFor(int numItems,
+                   const std::function<void(int, int)>& function);
+
+  juce::ThreadPool threadPool;
+  /** Pool threads to use, since the calling thread makes up the last one */
+  int numWorkers;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RegionAggregator)
+};
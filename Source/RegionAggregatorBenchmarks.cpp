@@ -0,0 +1,80 @@
+#include <JuceHeader.h>
+
+#include "RegionAggregator.h"
+
+//==============================================================================
+/*
+    Times every aggregate query on a synthetic table 100 times the size of
+    OWID's (about 250 regions by 1000 days), which should each stay well under
+    a second. Run with --run-benchmarks.
+*/
+class RegionAggregatorBenchmarks : public juce::UnitTest {
+ public:
+  RegionAggregatorBenchmarks()
+      : juce::UnitTest("RegionAggregator", "Benchmarks") {}
+
+  void runTest() override {
+    beginTest("Queries on a 100x expansion of the OWID table");
+
+    auto table = makeTable();
+    std::vector<int> regions(static_cast<size_t>(table.getNumRegions()));
+    std::iota(regions.begin(), regions.end(), 0);
+    juce::Range<int> rows{0, table.getNumRows()};
+    RegionAggregator aggregator;
+
+    time("sum", [&] { aggregator.sum(table, regions, rows); });
+    time("rank", [&] { aggregator.rank(table, regions, rows); });
+    time("rankOf", [&] { aggregator.rankOf(table, regions, 0, rows); });
+    time("windowSum", [&] { aggregator.windowSum(table, regions, rows, 7); });
+    time("windowGrowth",
+         [&] { aggregator.windowGrowth(table, regions, rows, 7, 100.0); });
+    time("topRegions", [&] {
+      aggregator.topRegions(table, regions, rows,
+                            RegionAggregator::kWindowGrowth, 7, 10, 100.0);
+    });
+  }
+
+ private:
+  static constexpr int kNumRegions = 25000;
+  static constexpr int kNumDays = 1000;
+  static constexpr int kNumRuns = 3;
+  static constexpr double kMaxMilliseconds = 1000.0;
+
+  /** Daily case counts that grow and shrink at random */
+  static DataTable makeTable() {
+    juce::Random random(0x0a99);
+    std::vector<std::string> names;
+    std::vector<double> values;
+    values.reserve(static_cast<size_t>(kNumRegions) * kNumDays);
+    for (int region = 0; region < kNumRegions; region++) {
+      names.push_back("Region " + std::to_string(region));
+      double cases = random.nextInt(1000);
+      for (int day = 0; day < kNumDays; day++) {
+        cases = juce::jmax(0.0, cases * (0.9 + 0.2 * random.nextDouble()));
+        values.push_back(std::round(cases));
+      }
+    }
+
+    std::vector<int> days(kNumDays);
+    std::iota(days.begin(), days.end(), 18000);
+
+    DataTable table;
+    table.setData(std::move(names), std::move(days), std::move(values));
+    return table;
+  }
+
+  /** Takes the fastest of a few runs, so that one slow run doesn't fail */
+  void time(const juce::String& query, const std::function<void()>& run) {
+    double elapsed = std::numeric_limits<double>::max();
+    for (int i = 0; i < kNumRuns; i++) {
+      auto startTime = juce::Time::getMillisecondCounterHiRes();
+      run();
+      elapsed = juce::jmin(
+          elapsed, juce::Time::getMillisecondCounterHiRes() - startTime);
+    }
+    logMessage(query + ": " + juce::String(elapsed, 1) + " ms");
+    expectLessThan(elapsed, kMaxMilliseconds, query);
+  }
+};
+
+static RegionAggregatorBenchmarks regionAggregatorBenchmarks;
@@ -0,0 +1,105 @@
+#include <JuceHeader.h>
+
+#include "RegionAggregator.h"
+
+//==============================================================================
+/*
+    Checks rank() against a plain stable sort, for whole numbers (which are
+    keyed by their distance from the largest), fractions with few significant
+    bits (which are packed with their index) and fractions with many (which
+    aren't), and checks that rankOf() agrees with it.
+*/
+class RegionAggregatorTests : public juce::UnitTest {
+ public:
+  RegionAggregatorTests()
+      : juce::UnitTest("RegionAggregator", "DataSonification") {}
+
+  void runTest() override {
+    beginTest("Ranks of whole numbers, with ties, zeros and negatives");
+    checkRanks(makeTable(300, 0.0));
+
+    beginTest("Ranks of fractions");
+    checkRanks(makeTable(300, 0.25));
+
+    beginTest("Ranks of fractions that differ in their lowest bits");
+    checkRanks(makeTable(300, 0.1));
+
+    beginTest("Ranks of a single region");
+    checkRanks(makeTable(1, 0.0));
+  }
+
+ private:
+  static constexpr int kNumDays = 40;
+
+  DataTable makeTable(int numRegions, double fraction) {
+    auto random = getRandom();
+    std::vector<std::string> names;
+    std::vector<double> values;
+    for (int region = 0; region < numRegions; region++) {
+      names.push_back("Region " + std::to_string(region));
+      for (int day = 0; day < kNumDays; day++) {
+        // Few distinct values, so that most rows have ties
+        const double kValues[] = {0.0, -0.0, -3.0, 1.0e6};
+        int choice = random.nextInt(8);
+        double value = choice < 4 ? kValues[choice] : random.nextInt(20);
+        value += random.nextInt(3) * fraction;
+        values.push_back(value);
+      }
+    }
+
+    std::vector<int> days(kNumDays);
+    std::iota(days.begin(), days.end(), 18000);
+    DataTable table;
+    table.setData(std::move(names), std::move(days), std::move(values));
+    return table;
+  }
+
+  void checkRanks(const DataTable& table) {
+    // Listed backwards, so positions and table indices differ
+    std::vector<int> regions(static_cast<size_t>(table.getNumRegions()));
+    std::iota(regions.rbegin(), regions.rend(), 0);
+    juce::Range<int> rows{5, kNumDays - 5};
+    int numRows = rows.getLength();
+    int numRegions = static_cast<int>(regions.size());
+    RegionAggregator aggregator(2);
+
+    auto ranks = aggregator.rank(table, regions, rows);
+    std::vector<int> expected(ranks.size());
+    std::vector<int> order(regions.size());
+    for (int row = 0; row < numRows; row++) {
+      auto value = [&](int i) {
+        return table.getColumn(regions[i])[rows.getStart() + row];
+      };
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(),
+                       [&](int a, int b) { return value(a) > value(b); });
+      for (int position = 0; position < numRegions; position++) {
+        expected[static_cast<size_t>(order[position]) * numRows + row] =
+            position;
+      }
+    }
+    expect(ranks == expected, "rank() differs from a stable sort");
+
+    for (int i = 0; i < numRegions; i++) {
+      auto regionRanks = aggregator.rankOf(table, regions, regions[i], rows);
+      expect(std::equal(regionRanks.begin(), regionRanks.end(),
+                        ranks.begin() + static_cast<size_t>(i) * numRows),
+             "rankOf() differs from rank() for region " + juce::String(i));
+    }
+
+    // A region that isn't listed ranks as if it were appended
+    auto withoutFirst = regions;
+    withoutFirst.erase(withoutFirst.begin());
+    auto appended = withoutFirst;
+    appended.push_back(regions.front());
+    auto appendedRanks = aggregator.rank(table, appended, rows);
+    auto unlistedRanks =
+        aggregator.rankOf(table, withoutFirst, regions.front(), rows);
+    expect(std::equal(unlistedRanks.begin(), unlistedRanks.end(),
+                      appendedRanks.begin() +
+                          static_cast<size_t>(numRegions - 1) * numRows),
+           "rankOf() differs from rank() for an unlisted region");
+  }
+};
+
+static RegionAggregatorTests regionAggregatorTests;
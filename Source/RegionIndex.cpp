@@ -0,0 +1,248 @@
+#include "RegionIndex.h"
+
+namespace {
+enum Tier { kExact, kNamePrefix, kWordPrefix, kSubstring, kFuzzy, kNoMatch };
+
+struct Match {
+  int region;
+  Tier tier;
+  float similarity;
+};
+
+bool isWordChar(char c) noexcept {
+  // Bytes of multi-byte UTF-8 characters count as letters
+  return std::isalnum(static_cast<unsigned char>(c)) ||
+         static_cast<unsigned char>(c) >= 0x80;
+}
+}  // namespace
+
+void RegionIndex::build(const DataTable& table) {
+  names = table.getRegionNames();
+  normalizedNames.clear();
+  normalizedNames.reserve(names.size());
+  wordStarts.clear();
+  numTrigrams.clear();
+  numTrigrams.reserve(names.size());
+
+  // Gather (trigram, region) pairs, then sort them into postings lists
+  std::vector<juce::uint64> pairs;
+  for (int region = 0; region < getNumRegions(); region++) {
+    auto name = normalize(names[region]);
+    for (int i = 0; i < static_cast<int>(name.size()); i++) {
+      if (isWordChar(name[i]) && (i == 0 || !isWordChar(name[i - 1]))) {
+        wordStarts.push_back({region, i});
+      }
+    }
+
+    auto nameTrigrams = getTrigrams(name);
+    numTrigrams.push_back(static_cast<int>(nameTrigrams.size()));
+    for (auto trigram : nameTrigrams) {
+      pairs.push_back((static_cast<juce::uint64>(trigram) << 32) |
+                      static_cast<juce::uint32>(region));
+    }
+    normalizedNames.push_back(std::move(name));
+  }
+
+  std::sort(wordStarts.begin(), wordStarts.end(),
+            [this](const WordStart& a, const WordStart& b) {
+              return std::strcmp(
+                         normalizedNames[a.region].c_str() + a.offset,
+                         normalizedNames[b.region].c_str() + b.offset) < 0;
+            });
+
+  std::sort(pairs.begin(), pairs.end());
+  trigrams.clear();
+  postingOffsets.clear();
+  postingRegions.clear();
+  postingRegions.reserve(pairs.size());
+  for (auto pair : pairs) {
+    auto trigram = static_cast<juce::uint32>(pair >> 32);
+    if (trigrams.empty() || trigrams.back() != trigram) {
+      trigrams.push_back(trigram);
+      postingOffsets.push_back(static_cast<int>(postingRegions.size()));
+    }
+    postingRegions.push_back(static_cast<int>(pair & 0xffffffffu));
+  }
+  postingOffsets.push_back(static_cast<int>(postingRegions.size()));
+
+  buildSparklines(table);
+}
+
+int RegionIndex::findRegion(const std::string& name) const {
+  auto position = std::find(names.begin(), names.end(), name);
+  return position == names.end() ? -1
+                                 : static_cast<int>(position - names.begin());
+}
+
+std::vector<int> RegionIndex::search(const std::string& query,
+                                     int maxResults) const {
+  auto normalizedQuery = normalize(query);
+  if (normalizedQuery.empty() || maxResults <= 0) return {};
+
+  std::vector<Match> matches;
+  std::vector<int> matchForRegion(names.size(), -1);
+  auto addMatch = [&](int region, Tier tier, float similarity) {
+    int& match = matchForRegion[region];
+    if (match < 0) {
+      match = static_cast<int>(matches.size());
+      matches.push_back({region, tier, similarity});
+    } else if (tier < matches[match].tier) {
+      matches[match].tier = tier;
+      matches[match].similarity = similarity;
+    }
+  };
+
+  // Names and words starting with the query sit together in wordStarts
+  const char* queryText = normalizedQuery.c_str();
+  auto getText = [this](const WordStart& start) {
+    return normalizedNames[start.region].c_str() + start.offset;
+  };
+  auto first = std::lower_bound(
+      wordStarts.begin(), wordStarts.end(), queryText,
+      [&](const WordStart& start, const char* text) {
+        return std::strcmp(getText(start), text) < 0;
+      });
+  for (auto it = first; it != wordStarts.end(); ++it) {
+    if (std::strncmp(getText(*it), queryText, normalizedQuery.size()) != 0) {
+      break;
+    }
+    const auto& name = normalizedNames[it->region];
+    Tier tier = it->offset != 0 ? kWordPrefix
+                : name.size() == normalizedQuery.size() ? kExact
+                                                        : kNamePrefix;
+    addMatch(it->region, tier, 1.0f);
+  }
+
+  // Count the trigrams each region shares with the query, only visiting the
+  // regions that share at least one
+  if (normalizedQuery.size() >= 3) {
+    auto queryTrigrams = getTrigrams(normalizedQuery);
+    std::vector<int> numShared(names.size(), 0);
+    std::vector<int> candidates;
+    for (auto trigram : queryTrigrams) {
+      auto position =
+          std::lower_bound(trigrams.begin(), trigrams.end(), trigram);
+      if (position == trigrams.end() || *position != trigram) continue;
+
+      auto index = position - trigrams.begin();
+      for (int i = postingOffsets[index]; i < postingOffsets[index + 1]; i++) {
+        int region = postingRegions[i];
+        if (numShared[region]++ == 0) candidates.push_back(region);
+      }
+    }
+
+    for (int region : candidates) {
+      if (normalizedNames[region].find(normalizedQuery) != std::string::npos) {
+        addMatch(region, kSubstring, 1.0f);
+        continue;
+      }
+
+      // Jaccard similarity of the two trigram sets
+      int shared = numShared[region];
+      float similarity =
+          static_cast<float>(shared) /
+          static_cast<float>(static_cast<int>(queryTrigrams.size()) +
+                             numTrigrams[region] - shared);
+      if (similarity >= kMinSimilarity) addMatch(region, kFuzzy, similarity);
+    }
+  }
+
+  // Only the results that will be returned need to be in order
+  int numResults = juce::jmin(maxResults, static_cast<int>(matches.size()));
+  std::partial_sort(
+      matches.begin(), matches.begin() + numResults, matches.end(),
+      [this](const Match& a, const Match& b) {
+        if (a.tier != b.tier) return a.tier < b.tier;
+        if (a.similarity != b.similarity) return a.similarity > b.similarity;
+        auto aLength = names[a.region].size();
+        auto bLength = names[b.region].size();
+        if (aLength != bLength) return aLength < bLength;
+        return a.region < b.region;
+      });
+
+  std::vector<int> results(numResults);
+  for (int i = 0; i < numResults; i++) results[i] = matches[i].region;
+  return results;
+}
+
+std::string RegionIndex::normalize(const std::string& text) {
+  std::string normalized;
+  normalized.reserve(text.size());
+  for (char c : text) {
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      if (!normalized.empty() && normalized.back() != ' ') {
+        normalized.push_back(' ');
+      }
+    } else {
+      normalized.push_back(static_cast<unsigned char>(c) < 0x80
+                               ? static_cast<char>(std::tolower(c))
+                               : c);
+    }
+  }
+  if (!normalized.empty() && normalized.back() == ' ') normalized.pop_back();
+  return normalized;
+}
+
+std::vector<juce::uint32> RegionIndex::getTrigrams(const std::string& text) {
+  std::vector<juce::uint32> result;
+  std::string padded;
+  for (size_t i = 0; i < text.size();) {
+    if (!isWordChar(text[i])) {
+      i++;
+      continue;
+    }
+
+    // Two spaces before each word and one after, so short words and the
+    // starts of words still make trigrams
+    size_t end = i;
+    while (end < text.size() && isWordChar(text[end])) end++;
+    padded = "  " + text.substr(i, end - i) + " ";
+    auto getByte = [&padded](size_t index) {
+      return static_cast<juce::uint32>(
+          static_cast<unsigned char>(padded[index]));
+    };
+    for (size_t j = 0; j + 3 <= padded.size(); j++) {
+      result.push_back((getByte(j) << 16) | (getByte(j + 1) << 8) |
+                       getByte(j + 2));
+    }
+    i = end;
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+void RegionIndex::buildSparklines(const DataTable& table) {
+  sparklines.assign(names.size() * kSparklinePoints, 0);
+  int numRows = table.getNumRows();
+  if (numRows == 0) return;
+
+  std::array<double, kSparklinePoints> peaks;
+  for (int region = 0; region < getNumRegions(); region++) {
+    // Keep the peak of each stretch, so spikes aren't averaged away
+    const double* column = table.getColumn(region);
+    for (int point = 0; point < kSparklinePoints; point++) {
+      int first =
+          static_cast<int>(static_cast<juce::int64>(point) * numRows /
+                           kSparklinePoints);
+      int last =
+          static_cast<int>(static_cast<juce::int64>(point + 1) * numRows /
+                           kSparklinePoints);
+      peaks[point] = juce::FloatVectorOperations::findMaximum(
+          column + first, juce::jmax(1, last - first));
+    }
+
+    auto range =
+        juce::FloatVectorOperations::findMinAndMax(peaks.data(),
+                                                   kSparklinePoints);
+    if (range.getLength() <= 0.0) continue;
+
+    juce::uint8* sparkline =
+        sparklines.data() + static_cast<size_t>(region) * kSparklinePoints;
+    for (int point = 0; point < kSparklinePoints; point++) {
+      sparkline[point] = static_cast<juce::uint8>(std::lround(
+          (peaks[point] - range.getStart()) / range.getLength() * 255.0));
+    }
+  }
+}
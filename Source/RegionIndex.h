@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "DataTable.h"
+
+//==============================================================================
+/*
+    A search index over a DataTable's region names, plus a small downsampled
+    sparkline of every region for previews.
+
+    Queries are matched case-insensitively, best first:
+      an exact name, a prefix of the name, a prefix of any word in the name,
+      anywhere in the name, and finally names sharing enough trigrams with
+      the query to survive typos ("germny" finds "Germany").
+
+    Prefixes are found by binary search over the sorted start of every word.
+    Trigrams are stored as sorted postings lists, so a query only touches the
+    regions that share at least one trigram with it.
+*/
+class RegionIndex {
+ public:
+  static constexpr int kSparklinePoints = 48;
+  static constexpr float kMinSimilarity = 0.3f;
+
+  /** Indexes every region of the table. Safe to call off the message thread. */
+  void build(const DataTable& table);
+
+  int getNumRegions() const noexcept { return static_cast<int>(names.size()); }
+  const std::string& getName(int region) const noexcept {
+    return names[region];
+  }
+
+  /** Returns the table index of a region, or -1 if there isn't one */
+  int findRegion(const std::string& name) const;
+
+  /**
+   * Returns the table indices of up to maxResults regions matching query,
+   * best first. An empty query matches nothing.
+   */
+  std::vector<int> search(const std::string& query, int maxResults) const;
+
+  /**
+   * Returns kSparklinePoints values between 0 and 255, the peaks of the
+   * region's values over equal stretches of the table scaled to its range
+   */
+  const juce::uint8* getSparkline(int region) const noexcept {
+    return sparklines.data() + static_cast<size_t>(region) * kSparklinePoints;
+  }
+
+ private:
+  struct WordStart {
+    int region;
+    int offset;
+  };
+
+  /** Lowercases ASCII letters and collapses runs of whitespace */
+  static std::string normalize(const std::string& text);
+  /** Returns the sorted, distinct trigrams of every word padded with spaces */
+  static std::vector<juce::uint32> getTrigrams(const std::string& text);
+
+  void buildSparklines(const DataTable& table);
+
+  std::vector<std::string> names;
+  std::vector<std::string> normalizedNames;
+
+  /** Every word start of every normalized name, sorted by the text from it */
+  std::vector<WordStart> wordStarts;
+
+  /**
+   * The regions containing trigrams[i] are postingRegions from
+   * postingOffsets[i] up to postingOffsets[i + 1], in ascending order
+   */
+  std::vector<juce::uint32> trigrams;
+  std::vector<int> postingOffsets;
+  std::vector<int> postingRegions;
+  std::vector<int> numTrigrams;
+
+  std::vector<juce::uint8> sparklines;
+};
@@ -0,0 +1,88 @@
+#include <JuceHeader.h>
+
+#include "RegionIndex.h"
+
+//==============================================================================
+/*
+    Times building a RegionIndex over 100k made-up region names, and searching
+    it as it would be searched while typing. Every search should take well
+    under a frame. Run with --run-benchmarks.
+*/
+class RegionIndexBenchmarks : public juce::UnitTest {
+ public:
+  RegionIndexBenchmarks() : juce::UnitTest("RegionIndex", "Benchmarks") {}
+
+  void runTest() override {
+    beginTest("Searching 100k region names");
+
+    auto table = makeTable();
+    RegionIndex index;
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    index.build(table);
+    logMessage("build: " +
+               juce::String(juce::Time::getMillisecondCounterHiRes() -
+                            startTime, 1) +
+               " ms");
+
+    // Every prefix of a name, as typed, then typos and a miss
+    juce::StringArray queries;
+    std::string name = index.getName(kNumRegions / 2);
+    for (size_t length = 1; length <= name.size(); length++) {
+      queries.add(name.substr(0, length));
+    }
+    for (auto* query : {"tamrolin", "vesk karo", "bo", "zzzzzz"}) {
+      queries.add(query);
+    }
+
+    double slowest = 0.0;
+    juce::String slowestQuery;
+    for (const auto& query : queries) {
+      startTime = juce::Time::getMillisecondCounterHiRes();
+      index.search(query.toStdString(), kMaxResults);
+      auto elapsed = juce::Time::getMillisecondCounterHiRes() - startTime;
+      if (elapsed > slowest) {
+        slowest = elapsed;
+        slowestQuery = query;
+      }
+    }
+    logMessage("slowest search: " + juce::String(slowest, 2) + " ms for \"" +
+               slowestQuery + "\"");
+    expectLessThan(slowest, kMaxSearchMilliseconds);
+  }
+
+ private:
+  static constexpr int kNumRegions = 100000;
+  static constexpr int kMaxResults = 50;
+  static constexpr double kMaxSearchMilliseconds = 16.0;
+
+  /** Names of one to three words of random syllables, with one day each */
+  static DataTable makeTable() {
+    const char* syllables[] = {"ka", "ro", "lin", "ta", "mo", "ves",
+                               "bor", "an", "de", "si", "qua", "ur",
+                               "nel", "pa", "tri", "go"};
+    int numSyllableTypes = juce::numElementsInArray(syllables);
+    juce::Random random(0x0035);
+    std::vector<std::string> names;
+    for (int region = 0; region < kNumRegions; region++) {
+      std::string name;
+      int numWords = 1 + random.nextInt(3);
+      for (int word = 0; word < numWords; word++) {
+        if (word > 0) name += ' ';
+        auto wordStart = name.size();
+        int numSyllables = 2 + random.nextInt(3);
+        for (int i = 0; i < numSyllables; i++) {
+          name += syllables[random.nextInt(numSyllableTypes)];
+        }
+        name[wordStart] = static_cast<char>(std::toupper(name[wordStart]));
+      }
+      names.push_back(std::move(name));
+    }
+
+    std::vector<double> values(names.size(), 1.0);
+    DataTable table;
+    table.setData(std::move(names), {18000}, std::move(values));
+    return table;
+  }
+};
+
+static RegionIndexBenchmarks regionIndexBenchmarks;
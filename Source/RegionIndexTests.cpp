@@ -0,0 +1,65 @@
+#include <JuceHeader.h>
+
+#include "RegionIndex.h"
+
+//==============================================================================
+/*
+    Checks that RegionIndex::search() ranks matches by tier, finds misspelled
+    names, and ignores case and extra whitespace.
+*/
+class RegionIndexTests : public juce::UnitTest {
+ public:
+  RegionIndexTests() : juce::UnitTest("RegionIndex", "DataSonification") {}
+
+  void runTest() override {
+    RegionIndex index;
+    index.build(makeTable({"France", "Nokorea", "South Korea", "Koria",
+                           "Koreatown", "North Korea", "Korea", "Germany",
+                           "Guernsey", "Bosnia and  Herzegovina"}));
+
+    // Matches in the same tier and of the same length keep the table's order
+    beginTest("Matches are ordered exact, prefix, word, substring, fuzzy");
+    expect(getNames(index, index.search("korea", 10)) ==
+           juce::StringArray{"Korea", "Koreatown", "South Korea",
+                             "North Korea", "Nokorea", "Koria"});
+    expect(getNames(index, index.search("korea", 2)) ==
+           juce::StringArray{"Korea", "Koreatown"});
+
+    beginTest("Misspelled names are found by their trigrams");
+    auto results = index.search("germny", 10);
+    expect(!results.empty() && index.getName(results[0]) == "Germany");
+    expect(index.search("xqzvw", 10).empty());
+
+    beginTest("Case and whitespace are ignored");
+    expect(getNames(index, index.search("  SOUTH\tkorea ", 1)) ==
+           juce::StringArray{"South Korea"});
+    expect(getNames(index, index.search("bosnia and herzegovina", 1)) ==
+           juce::StringArray{"Bosnia and  Herzegovina"});
+
+    beginTest("An empty query matches nothing");
+    expect(index.search("", 10).empty());
+    expect(index.search(" \t ", 10).empty());
+    expect(index.search("korea", 0).empty());
+
+    beginTest("Regions are found by their exact name");
+    expectEquals(index.findRegion("Korea"), 6);
+    expectEquals(index.findRegion("korea"), -1);
+  }
+
+ private:
+  static DataTable makeTable(std::vector<std::string> names) {
+    std::vector<double> values(names.size(), 1.0);
+    DataTable table;
+    table.setData(std::move(names), {18000}, std::move(values));
+    return table;
+  }
+
+  static juce::StringArray getNames(const RegionIndex& index,
+                                    const std::vector<int>& regions) {
+    juce::StringArray names;
+    for (int region : regions) names.add(index.getName(region));
+    return names;
+  }
+};
+
+static RegionIndexTests regionIndexTests;
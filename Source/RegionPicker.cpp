@@ -0,0 +1,171 @@
+#include "RegionPicker.h"
+
+namespace {
+const int kSearchBoxHeight = 28;
+const int kRowHeight = 22;
+
+//==============================================================================
+/* The search box and results list shown inside the picker's callout */
+class RegionSearchPanel : public juce::Component,
+                          private juce::ListBoxModel,
+                          private juce::TextEditor::Listener {
+ public:
+  RegionSearchPanel(const RegionIndex& regionIndex,
+                    std::function<void(int)> onRegionChosen)
+      : index(regionIndex), onChosen(std::move(onRegionChosen)) {
+    searchBox.setTextToShowWhenEmpty("Search regions", juce::Colours::grey);
+    searchBox.addListener(this);
+    addAndMakeVisible(searchBox);
+
+    listBox.setModel(this);
+    listBox.setRowHeight(kRowHeight);
+    addAndMakeVisible(listBox);
+
+    setSize(360, 420);
+  }
+
+  void resized() override {
+    auto bounds = getLocalBounds();
+    searchBox.setBounds(bounds.removeFromTop(kSearchBoxHeight));
+    bounds.removeFromTop(4);
+    listBox.setBounds(bounds);
+  }
+
+  void parentHierarchyChanged() override {
+    if (isShowing()) searchBox.grabKeyboardFocus();
+  }
+
+ private:
+  //==============================================================================
+  int getNumRows() override {
+    // Every region is listed until something is typed
+    return showingAll ? index.getNumRegions()
+                      : static_cast<int>(results.size());
+  }
+
+  void paintListBoxItem(int row, juce::Graphics& g, int width, int height,
+                        bool rowIsSelected) override {
+    if (row < 0 || row >= getNumRows()) return;
+    int region = getRegion(row);
+
+    if (rowIsSelected) {
+      g.fillAll(getLookAndFeel().findColour(
+          juce::TextEditor::highlightColourId));
+    }
+
+    auto bounds = juce::Rectangle<int>(width, height).reduced(4, 2);
+    auto sparklineArea = bounds.removeFromRight(width / 4).toFloat();
+    bounds.removeFromRight(4);
+
+    g.setColour(getLookAndFeel().findColour(juce::ListBox::textColourId));
+    g.setFont(height * 0.7f);
+    g.drawText(juce::String(index.getName(region)), bounds,
+               juce::Justification::centredLeft, true);
+
+    // Draw the precomputed preview rather than reading the region's data
+    const juce::uint8* sparkline = index.getSparkline(region);
+    juce::Path path;
+    for (int i = 0; i < RegionIndex::kSparklinePoints; i++) {
+      float x = sparklineArea.getX() + sparklineArea.getWidth() * i /
+                                           (RegionIndex::kSparklinePoints - 1);
+      float y = sparklineArea.getBottom() -
+                sparklineArea.getHeight() * sparkline[i] / 255.0f;
+      if (i == 0) {
+        path.startNewSubPath(x, y);
+      } else {
+        path.lineTo(x, y);
+      }
+    }
+    g.setColour(juce::Colours::orange);
+    g.strokePath(path, juce::PathStrokeType(1.0f));
+  }
+
+  void listBoxItemClicked(int row, const juce::MouseEvent&) override {
+    choose(row);
+  }
+
+  void returnKeyPressed(int lastRowSelected) override {
+    choose(lastRowSelected);
+  }
+
+  //==============================================================================
+  void textEditorTextChanged(juce::TextEditor&) override {
+    auto query = searchBox.getText().trim();
+    showingAll = query.isEmpty();
+    results = showingAll ? std::vector<int>()
+                         : index.search(query.toStdString(),
+                                        RegionPicker::kMaxResults);
+
+    listBox.updateContent();
+    listBox.deselectAllRows();
+    listBox.scrollToEnsureRowIsOnscreen(0);
+    listBox.repaint();
+  }
+
+  void textEditorReturnKeyPressed(juce::TextEditor&) override {
+    // Pick the best match, unless a row has been selected
+    choose(juce::jmax(0, listBox.getSelectedRow()));
+  }
+
+  void textEditorEscapeKeyPressed(juce::TextEditor&) override { dismiss(); }
+
+  //==============================================================================
+  int getRegion(int row) const {
+    return showingAll ? row : results[static_cast<size_t>(row)];
+  }
+
+  void choose(int row) {
+    if (row < 0 || row >= getNumRows()) return;
+    onChosen(getRegion(row));
+    dismiss();
+  }
+
+  void dismiss() {
+    if (auto* callOutBox = findParentComponentOfClass<juce::CallOutBox>()) {
+      callOutBox->dismiss();
+    }
+  }
+
+  const RegionIndex& index;
+  std::function<void(int)> onChosen;
+
+  juce::TextEditor searchBox;
+  juce::ListBox listBox;
+  bool showingAll = true;
+  std::vector<int> results;
+};
+}  // namespace
+
+//==============================================================================
+RegionPicker::RegionPicker() {}
+
+RegionPicker::~RegionPicker() {
+  // The search refers to this picker's index, so it can't outlive it
+  delete callOut.getComponent();
+}
+
+void RegionPicker::setIndex(RegionIndex&& newIndex) {
+  delete callOut.getComponent();
+  index = std::move(newIndex);
+  setSelectedRegion(-1, juce::dontSendNotification);
+}
+
+void RegionPicker::setSelectedRegion(int region,
+                                     juce::NotificationType notification) {
+  selectedRegion = region;
+  setButtonText(region >= 0 ? juce::String(index.getName(region))
+                            : juce::String());
+  if (notification != juce::dontSendNotification && onRegionChanged) {
+    onRegionChanged(region);
+  }
+}
+
+void RegionPicker::clicked() {
+  if (index.getNumRegions() == 0) return;
+
+  auto panel = std::make_unique<RegionSearchPanel>(index, [this](int region) {
+    setSelectedRegion(region, juce::sendNotification);
+  });
+  callOut = &juce::CallOutBox::launchAsynchronously(
+      std::move(panel), getScreenBounds(), nullptr);
+}
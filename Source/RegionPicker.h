@@ -0,0 +1,43 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "RegionIndex.h"
+
+//==============================================================================
+/*
+    A button showing the selected region, which opens a search box over every
+    region when clicked.
+
+    Results update on every keystroke. They are shown in a ListBox, which only
+    paints the rows that are visible, each with a sparkline preview of the
+    region's data, so tens of thousands of regions stay quick to browse.
+*/
+class RegionPicker : public juce::TextButton {
+ public:
+  static constexpr int kMaxResults = 1000;
+
+  RegionPicker();
+  ~RegionPicker() override;
+
+  /** Replaces the regions to choose from, closing the search if it's open */
+  void setIndex(RegionIndex&& newIndex);
+  const RegionIndex& getIndex() const noexcept { return index; }
+
+  /** Returns the selected region's table index, or -1 if there are none */
+  int getSelectedRegion() const noexcept { return selectedRegion; }
+  void setSelectedRegion(int region, juce::NotificationType notification);
+
+  /** Called with the table index of each region the user picks */
+  std::function<void(int)> onRegionChanged;
+
+ protected:
+  void clicked() override;
+
+ private:
+  RegionIndex index;
+  int selectedRegion = -1;
+  juce::Component::SafePointer<juce::CallOutBox> callOut;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RegionPicker)
+};
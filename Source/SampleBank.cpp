@@ -0,0 +1,229 @@
+#include "SampleBank.h"
+
+#if JUCE_LINUX
+#include <unistd.h>
+#elif JUCE_MAC
+#include <mach/mach.h>
+#endif
+
+namespace {
+const char kMagic[4] = {'D', 'S', 'B', '1'};
+const size_t kHeaderSize = 4 + 8 + 4;
+const size_t kZoneSize = 4 * 3 + 8 * 2;
+
+struct ConvertedZone {
+  int rootNote;
+  std::vector<float> samples;
+};
+}  // namespace
+
+bool SampleBank::load(const juce::File& file) {
+  unload();
+  LoadStats stats;
+  stats.residentBytesBefore = getResidentMemoryBytes();
+  auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+  mappedFile = std::make_unique<juce::MemoryMappedFile>(
+      file, juce::MemoryMappedFile::readOnly);
+  auto* data = static_cast<const char*>(mappedFile->getData());
+  auto size = mappedFile->getSize();
+  if (data == nullptr || size < kHeaderSize ||
+      std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+    unload();
+    return false;
+  }
+
+  auto sampleRateBits = juce::ByteOrder::littleEndianInt64(data + 4);
+  std::memcpy(&sampleRate, &sampleRateBits, sizeof(sampleRate));
+  auto numZones = juce::ByteOrder::littleEndianInt(data + 12);
+  if (sampleRate <= 0.0 || numZones == 0 ||
+      kHeaderSize + numZones * kZoneSize > size) {
+    unload();
+    return false;
+  }
+
+  for (juce::uint32 i = 0; i < numZones; i++) {
+    const char* entry = data + kHeaderSize + i * kZoneSize;
+    Zone zone;
+    zone.rootNote = (int)juce::ByteOrder::littleEndianInt(entry);
+    zone.lowNote = (int)juce::ByteOrder::littleEndianInt(entry + 4);
+    zone.highNote = (int)juce::ByteOrder::littleEndianInt(entry + 8);
+    zone.numFrames = juce::ByteOrder::littleEndianInt64(entry + 12);
+    auto offset = (juce::uint64)juce::ByteOrder::littleEndianInt64(entry + 20);
+
+    // The root is looked up in a 128-note table when a note starts, so one
+    // outside it would give a zero (and then infinite) pitch ratio
+    bool hasValidNotes = zone.rootNote >= 0 && zone.rootNote <= 127 &&
+                         zone.lowNote <= zone.highNote;
+    if (!hasValidNotes || zone.numFrames <= 0 || offset % sizeof(float) != 0 ||
+        offset + (juce::uint64)zone.numFrames * sizeof(float) > size) {
+      unload();
+      return false;
+    }
+    zone.samples = reinterpret_cast<const float*>(data + offset);
+
+    // Preload the start of every zone, which also faults in its first pages
+    auto numAttackFrames =
+        juce::jmin((juce::int64)kAttackFrames, zone.numFrames);
+    zone.attack.assign(zone.samples, zone.samples + numAttackFrames);
+
+    zones.push_back(std::move(zone));
+  }
+
+  // Play each note with the zone covering it, or else the closest root
+  for (int note = 0; note < 128; note++) {
+    int bestZone = 0;
+    int bestDistance = std::numeric_limits<int>::max();
+    for (int i = 0; i < zones.size(); i++) {
+      const auto& zone = zones[i];
+      int distance = note >= zone.lowNote && note <= zone.highNote
+                         ? -1
+                         : std::abs(note - zone.rootNote);
+      if (distance < bestDistance) {
+        bestDistance = distance;
+        bestZone = i;
+      }
+    }
+    zoneForNote[(size_t)note] = bestZone;
+  }
+
+  stats.loadTimeMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+  stats.mappedBytes = (juce::int64)size;
+  stats.residentBytesAfter = getResidentMemoryBytes();
+  lastLoadStats = stats;
+
+  DBG("Loaded " << (int)zones.size() << " zones ("
+                << stats.mappedBytes / (1024 * 1024) << " MB mapped) in "
+                << stats.loadTimeMs << " ms, RSS "
+                << stats.residentBytesBefore / (1024 * 1024) << " MB -> "
+                << stats.residentBytesAfter / (1024 * 1024) << " MB");
+  return true;
+}
+
+void SampleBank::unload() {
+  zones.clear();
+  mappedFile.reset();
+}
+
+bool SampleBank::convertAudioFiles(const juce::Array<juce::File>& audioFiles,
+                                   const juce::File& bankFile,
+                                   double sampleRate) {
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+
+  std::vector<ConvertedZone> converted;
+  for (const auto& audioFile : audioFiles) {
+    std::unique_ptr<juce::AudioFormatReader> reader(
+        formatManager.createReaderFor(audioFile));
+    if (reader == nullptr || reader->lengthInSamples <= 0) continue;
+
+    // Mix down to mono
+    int numChannels = (int)reader->numChannels;
+    int numFrames = (int)reader->lengthInSamples;
+    juce::AudioBuffer<float> buffer(numChannels, numFrames);
+    reader->read(&buffer, 0, numFrames, 0, true, true);
+    for (int channel = 1; channel < numChannels; channel++) {
+      buffer.addFrom(0, 0, buffer, channel, 0, numFrames);
+    }
+    buffer.applyGain(0, 0, numFrames, 1.0f / numChannels);
+
+    // Resample to the bank's rate ahead of time, so playback only has to
+    // shift pitch
+    double ratio = reader->sampleRate / sampleRate;
+    ConvertedZone zone;
+    zone.rootNote = juce::jlimit(
+        0, 127, audioFile.getFileNameWithoutExtension().getTrailingIntValue());
+    zone.samples.resize((size_t)(numFrames / ratio));
+    juce::LagrangeInterpolator interpolator;
+    interpolator.process(ratio, buffer.getReadPointer(0), zone.samples.data(),
+                         (int)zone.samples.size());
+
+    converted.push_back(std::move(zone));
+  }
+
+  if (converted.empty()) return false;
+  std::sort(converted.begin(), converted.end(),
+            [](const ConvertedZone& a, const ConvertedZone& b) {
+              return a.rootNote < b.rootNote;
+            });
+
+  bankFile.deleteFile();
+  juce::FileOutputStream out(bankFile);
+  if (out.failedToOpen()) return false;
+
+  out.write(kMagic, sizeof(kMagic));
+  juce::int64 sampleRateBits;
+  std::memcpy(&sampleRateBits, &sampleRate, sizeof(sampleRateBits));
+  out.writeInt64(sampleRateBits);
+  out.writeInt((int)converted.size());
+
+  // Each zone covers the notes up to halfway to its neighbours
+  juce::uint64 offset = kHeaderSize + converted.size() * kZoneSize;
+  for (size_t i = 0; i < converted.size(); i++) {
+    int root = converted[i].rootNote;
+    int lowNote = i == 0 ? 0 : (converted[i - 1].rootNote + root) / 2 + 1;
+    int highNote = i + 1 == converted.size()
+                       ? 127
+                       : (root + converted[i + 1].rootNote) / 2;
+
+    out.writeInt(root);
+    out.writeInt(lowNote);
+    out.writeInt(highNote);
+    out.writeInt64((juce::int64)converted[i].samples.size());
+    out.writeInt64((juce::int64)offset);
+    offset += converted[i].samples.size() * sizeof(float);
+  }
+
+  // Samples are written in the machine's own (little-endian) float format, so
+  // they can be played straight out of the mapping
+  for (const auto& zone : converted) {
+    out.write(zone.samples.data(), zone.samples.size() * sizeof(float));
+  }
+
+  out.flush();
+  return out.getStatus().wasOk();
+}
+
+juce::int64 SampleBank::getResidentMemoryBytes() {
+#if JUCE_LINUX
+  // The second field of statm is the resident set, in pages
+  auto fields = juce::StringArray::fromTokens(
+      juce::File("/proc/self/statm").loadFileAsString(), false);
+  if (fields.size() < 2) return -1;
+  return fields[1].getLargeIntValue() * (juce::int64)sysconf(_SC_PAGESIZE);
+#elif JUCE_MAC
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info,
+                &count) != KERN_SUCCESS) {
+    return -1;
+  }
+  return (juce::int64)info.resident_size;
+#else
+  return -1;
+#endif
+}
+
+//==============================================================================
+void SamplerVoice::startNote(const SampleBank::Zone* noteZone,
+                             double pitchRatio,
+                             double outputSampleRate) noexcept {
+  zone = noteZone;
+  position = 0.0;
+  if (bank != nullptr && outputSampleRate > 0.0) {
+    increment = pitchRatio * bank->getSampleRate() / outputSampleRate;
+  }
+}
+
+float SamplerVoice::getNextSample() noexcept {
+  if (zone == nullptr) return 0.0f;
+
+  auto frame = (juce::int64)position;
+  if (frame + 1 >= zone->numFrames) return 0.0f;
+
+  auto fraction = (float)(position - (double)frame);
+  float current = zone->getSample(frame);
+  float next = zone->getSample(frame + 1);
+  position += increment;
+  return current + fraction * (next - current);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    A multi-sampled instrument stored as preconverted mono float PCM in a
+    single file, which is memory-mapped rather than read.
+
+    Sample data is played straight out of the mapping without being copied,
+    apart from the first kAttackFrames of every zone. Those are copied into
+    memory when the bank loads, so starting a note never waits on the disk.
+
+    File layout (little-endian):
+      "DSB1", float64 sample rate, uint32 number of zones,
+      per zone: int32 root note, int32 lowest note, int32 highest note,
+                uint64 number of frames, uint64 byte offset of its samples,
+      then every zone's float32 samples.
+*/
+class SampleBank {
+ public:
+  static constexpr int kAttackFrames = 16384;
+
+  struct Zone {
+    int rootNote = 60;
+    int lowNote = 0;
+    int highNote = 127;
+    /** Points into the memory-mapped file */
+    const float* samples = nullptr;
+    juce::int64 numFrames = 0;
+    std::vector<float> attack;
+
+    float getSample(juce::int64 frame) const noexcept {
+      return frame < (juce::int64)attack.size() ? attack[(size_t)frame]
+                                                : samples[frame];
+    }
+  };
+
+  struct LoadStats {
+    double loadTimeMs = 0.0;
+    juce::int64 mappedBytes = 0;
+    juce::int64 residentBytesBefore = -1;
+    juce::int64 residentBytesAfter = -1;
+  };
+
+  /**
+   * Maps a bank file, replacing any loaded bank. Returns false on failure,
+   * which includes a zone whose root note is outside 0-127 or whose lowest
+   * note is above its highest.
+   */
+  bool load(const juce::File& file);
+  void unload();
+  bool isLoaded() const noexcept { return !zones.empty(); }
+
+  double getSampleRate() const noexcept { return sampleRate; }
+  const LoadStats& getLastLoadStats() const noexcept { return lastLoadStats; }
+
+  /** Returns the zone to play a MIDI note with, or nullptr if none is loaded */
+  const Zone* getZoneForNote(int midiNote) const noexcept {
+    if (zones.empty()) return nullptr;
+    return &zones[(size_t)zoneForNote[(size_t)juce::jlimit(0, 127, midiNote)]];
+  }
+
+  /**
+   * Converts audio files into a bank at the given sample rate, mixing them
+   * down to mono. Each file's root note is the number at the end of its name
+   * (e.g. "piano_60.wav"), and every note is played by the nearest root.
+   */
+  static bool convertAudioFiles(const juce::Array<juce::File>& audioFiles,
+                                const juce::File& bankFile, double sampleRate);
+
+  /** Returns the process's resident memory, or -1 if it's unavailable */
+  static juce::int64 getResidentMemoryBytes();
+
+ private:
+  std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+  std::vector<Zone> zones;
+  std::array<int, 128> zoneForNote{};
+  double sampleRate = 44100.0;
+  LoadStats lastLoadStats;
+};
+
+//==============================================================================
+/* Plays one note at a time from a SampleBank, pitch-shifted by resampling */
+class SamplerVoice {
+ public:
+  void setBank(const SampleBank* newBank) noexcept { bank = newBank; }
+
+  /** pitchRatio is the note's frequency divided by the zone's root frequency */
+  void startNote(const SampleBank::Zone* noteZone, double pitchRatio,
+                 double outputSampleRate) noexcept;
+
+  /** Returns the next linearly interpolated sample, or 0 once it has ended */
+  float getNextSample() noexcept;
+
+  double getPosition() const noexcept { return position; }
+  void setPosition(double newPosition) noexcept { position = newPosition; }
+
+ private:
+  const SampleBank* bank = nullptr;
+  const SampleBank::Zone* zone = nullptr;
+  double position = 0.0;
+  double increment = 1.0;
+};
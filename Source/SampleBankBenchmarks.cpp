@@ -0,0 +1,117 @@
+#include <JuceHeader.h>
+
+#include "SampleBank.h"
+
+//==============================================================================
+/*
+    Writes a 500 MB bank, then measures how long it takes to load and how much
+    of it becomes resident, both after loading and after every sample has been
+    played once. Run with --run-benchmarks.
+
+    The bank was just written, so it's read from the page cache. A bank that
+    isn't cached only costs more for the attack segments copied at load time.
+*/
+class SampleBankBenchmarks : public juce::UnitTest {
+ public:
+  SampleBankBenchmarks() : juce::UnitTest("SampleBank", "Benchmarks") {}
+
+  void runTest() override {
+    beginTest("Loading and playing a 500 MB bank");
+
+    auto file = juce::File::createTempFile(".dsbank");
+    expect(writeBank(file));
+
+    SampleBank bank;
+    expect(bank.load(file));
+    if (!bank.isLoaded()) {
+      file.deleteFile();
+      return;
+    }
+
+    const auto& stats = bank.getLastLoadStats();
+    logMessage("Mapped " + toMegabytes(stats.mappedBytes) + " in " +
+               juce::String(stats.loadTimeMs, 1) + " ms");
+    logMessage("RSS before loading " + toMegabytes(stats.residentBytesBefore) +
+               ", after " + toMegabytes(stats.residentBytesAfter));
+
+    // Only the attack segments and the pages they were copied from should be
+    // resident, not the whole bank
+    if (stats.residentBytesBefore >= 0) {
+      expectLessThan(stats.residentBytesAfter - stats.residentBytesBefore,
+                     (juce::int64)kMaxLoadedBytes);
+    }
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    double sum = 0.0;
+    for (int zone = 0; zone < kNumZones; zone++) {
+      const auto* bankZone = bank.getZoneForNote(kFirstRootNote + zone);
+      for (juce::int64 frame = 0; frame < bankZone->numFrames; frame++) {
+        sum += bankZone->getSample(frame);
+      }
+    }
+    auto elapsed = juce::Time::getMillisecondCounterHiRes() - startTime;
+    logMessage("Read every sample in " + juce::String(elapsed, 1) +
+               " ms (sum " + juce::String(sum, 1) + "), RSS " +
+               toMegabytes(SampleBank::getResidentMemoryBytes()));
+
+    bank.unload();
+    file.deleteFile();
+  }
+
+ private:
+  static constexpr int kNumZones = 64;
+  static constexpr int kFirstRootNote = 32;
+  static constexpr juce::int64 kFramesPerZone = 2048000;
+  static constexpr int kFramesPerWrite = 65536;
+  static constexpr juce::int64 kMaxLoadedBytes = 64 * 1024 * 1024;
+
+  /**
+   * Writes kNumZones zones of a quiet sine, one root note apart, in the
+   * layout described in SampleBank.h
+   */
+  static bool writeBank(const juce::File& file) {
+    juce::FileOutputStream out(file);
+    if (out.failedToOpen()) return false;
+
+    out.write("DSB1", 4);
+    double sampleRate = 44100.0;
+    juce::int64 sampleRateBits;
+    std::memcpy(&sampleRateBits, &sampleRate, sizeof(sampleRateBits));
+    out.writeInt64(sampleRateBits);
+    out.writeInt(kNumZones);
+
+    juce::int64 offset = 4 + 8 + 4 + kNumZones * (4 * 3 + 8 * 2);
+    for (int zone = 0; zone < kNumZones; zone++) {
+      int root = kFirstRootNote + zone;
+      out.writeInt(root);
+      out.writeInt(zone == 0 ? 0 : root);
+      out.writeInt(zone + 1 == kNumZones ? 127 : root);
+      out.writeInt64(kFramesPerZone);
+      out.writeInt64(offset);
+      offset += kFramesPerZone * (juce::int64)sizeof(float);
+    }
+
+    std::vector<float> block(kFramesPerWrite);
+    for (int i = 0; i < kFramesPerWrite; i++) {
+      block[(size_t)i] = 0.25f * std::sin(0.05f * (float)i);
+    }
+    for (int zone = 0; zone < kNumZones; zone++) {
+      for (juce::int64 frame = 0; frame < kFramesPerZone;
+           frame += kFramesPerWrite) {
+        auto length = juce::jmin((juce::int64)kFramesPerWrite,
+                                 kFramesPerZone - frame);
+        out.write(block.data(), (size_t)length * sizeof(float));
+      }
+    }
+
+    out.flush();
+    return out.getStatus().wasOk();
+  }
+
+  static juce::String toMegabytes(juce::int64 bytes) {
+    if (bytes < 0) return "unavailable";
+    return juce::String((double)bytes / (1024.0 * 1024.0), 1) + " MB";
+  }
+};
+
+static SampleBankBenchmarks sampleBankBenchmarks;
@@ -0,0 +1,83 @@
+#include <JuceHeader.h>
+
+#include "SampleBank.h"
+
+//==============================================================================
+/* Loads hand-written bank files, including ones with impossible zones */
+class SampleBankTests : public juce::UnitTest {
+ public:
+  SampleBankTests() : juce::UnitTest("SampleBank", "DataSonification") {}
+
+  void runTest() override {
+    beginTest("Notes play with the zone covering them, or the nearest root");
+    {
+      auto file = writeBank({{48, 0, 53}, {60, 54, 66}, {72, 80, 127}});
+      SampleBank bank;
+      expect(bank.load(file));
+      expectEquals(bank.getZoneForNote(0)->rootNote, 48);
+      expectEquals(bank.getZoneForNote(54)->rootNote, 60);
+      expectEquals(bank.getZoneForNote(127)->rootNote, 72);
+      // 67 to 79 aren't covered, so 70 goes to the closest root
+      expectEquals(bank.getZoneForNote(70)->rootNote, 72);
+      expectEquals(bank.getZoneForNote(200)->rootNote, 72);
+
+      bank.unload();
+      file.deleteFile();
+    }
+
+    beginTest("Zones with a root outside 0-127 are rejected");
+    expectRejected({{60, 0, 127}, {128, 0, 127}});
+    expectRejected({{-1, 0, 127}});
+
+    beginTest("Zones whose lowest note is above their highest are rejected");
+    expectRejected({{60, 0, 59}, {64, 70, 65}});
+  }
+
+ private:
+  struct ZoneNotes {
+    int rootNote, lowNote, highNote;
+  };
+
+  static constexpr int kNumFrames = 64;
+
+  /** Writes a bank in the layout described in SampleBank.h */
+  static juce::File writeBank(const std::vector<ZoneNotes>& zones) {
+    auto file = juce::File::createTempFile(".dsbank");
+    juce::FileOutputStream out(file);
+
+    out.write("DSB1", 4);
+    double sampleRate = 44100.0;
+    juce::int64 sampleRateBits;
+    std::memcpy(&sampleRateBits, &sampleRate, sizeof(sampleRateBits));
+    out.writeInt64(sampleRateBits);
+    out.writeInt((int)zones.size());
+
+    auto offset = 4 + 8 + 4 + (juce::int64)zones.size() * (4 * 3 + 8 * 2);
+    for (const auto& zone : zones) {
+      out.writeInt(zone.rootNote);
+      out.writeInt(zone.lowNote);
+      out.writeInt(zone.highNote);
+      out.writeInt64(kNumFrames);
+      out.writeInt64(offset);
+      offset += kNumFrames * sizeof(float);
+    }
+
+    std::vector<float> samples(kNumFrames, 0.5f);
+    for (size_t i = 0; i < zones.size(); i++) {
+      out.write(samples.data(), samples.size() * sizeof(float));
+    }
+    out.flush();
+    return file;
+  }
+
+  void expectRejected(const std::vector<ZoneNotes>& zones) {
+    auto file = writeBank(zones);
+    SampleBank bank;
+    expect(!bank.load(file));
+    expect(!bank.isLoaded());
+    expect(bank.getZoneForNote(60) == nullptr);
+    file.deleteFile();
+  }
+};
+
+static SampleBankTests sampleBankTests;
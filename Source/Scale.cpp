@@ -0,0 +1,42 @@
+#include "Scale.h"
+
+namespace {
+const juce::Array<int> kDiatonicPitches{0, 2, 4, 5, 7, 9, 11};
+const juce::Array<int> kPentatonicPitches{0, 2, 4, 7, 9};
+const juce::Array<int> kWholeTonePitches{0, 2, 4, 6, 8, 10};
+}  // namespace
+
+int Scale::quantize(double note, ScaleId scaleId) {
+  bool isQuantized = false;
+  int quantizedNote = static_cast<int>(note);
+
+  const juce::Array<int>* currentScale;
+  switch (scaleId) {
+    case kDiatonic:
+      currentScale = &kDiatonicPitches;
+      break;
+    case kPentatonic:
+      currentScale = &kPentatonicPitches;
+      break;
+    case kWholeTone:
+      currentScale = &kWholeTonePitches;
+      break;
+    default:
+      return quantizedNote;
+  }
+
+  while (!isQuantized) {
+    int currentPitchClass = quantizedNote % kNumPitchClasses;
+    for (int pitchClass : *currentScale) {
+      if (currentPitchClass == pitchClass) {
+        isQuantized = true;
+        break;
+      }
+    }
+    if (!isQuantized) {
+      quantizedNote--;
+    }
+  }
+
+  return quantizedNote;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    The scales that notes can be quantized to. Quantizing moves a note down to
+    the nearest pitch in the scale, and the chromatic scale leaves it as is.
+*/
+class Scale {
+ public:
+  enum ScaleId { kNoScale, kChromatic, kDiatonic, kPentatonic, kWholeTone };
+
+  static constexpr int kNumPitchClasses = 12;
+
+  /** Truncates a fractional MIDI note, then moves it down into the scale */
+  static int quantize(double note, ScaleId scaleId);
+};
@@ -0,0 +1,551 @@
+#include "SnapshotHistory.h"
+
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+const char kMagic[4] = {'D', 'S', 'H', '3'};
+// Each record starts with the size of its body and a hash of it
+const int kRecordHeaderSize = 4 + 4;
+// Whole numbers below 2^53 convert to int64 and back exactly
+const double kMaxWholeNumber = 9007199254740992.0;
+
+void writeVarint(juce::MemoryOutputStream& out, juce::uint64 value) {
+  while (value >= 0x80) {
+    out.writeByte(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.writeByte(static_cast<char>(value));
+}
+
+bool readVarint(const juce::uint8*& cursor, const juce::uint8* end,
+                juce::uint64& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+    auto byte = *cursor++;
+    value |= static_cast<juce::uint64>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+juce::uint64 zigzagEncode(juce::int64 value) {
+  return (static_cast<juce::uint64>(value) << 1) ^
+         static_cast<juce::uint64>(value >> 63);
+}
+
+juce::int64 zigzagDecode(juce::uint64 value) {
+  return static_cast<juce::int64>(value >> 1) ^
+         -static_cast<juce::int64>(value & 1);
+}
+
+juce::uint64 toBits(double value) {
+  juce::uint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double fromBits(juce::uint64 bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/** 32-bit FNV-1a, to catch records that were damaged or cut short */
+juce::uint32 hashBytes(const void* data, size_t size) {
+  juce::uint32 hash = 2166136261u;
+  auto* bytes = static_cast<const juce::uint8*>(data);
+  for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+  return hash;
+}
+
+/** Excludes -0, which would come back as +0 */
+bool isWholeNumber(double value) {
+  return std::abs(value) < kMaxWholeNumber && value == std::floor(value) &&
+         !(value == 0.0 && std::signbit(value));
+}
+
+/**
+ * Writes a value relative to a reference. Whole numbers are an even varint
+ * holding their zigzagged difference. Anything else is a 1, then a byte
+ * counting the XOR's leading and trailing zero bytes, then the bytes between.
+ */
+void writeValue(juce::MemoryOutputStream& out, double value,
+                double reference) {
+  if (isWholeNumber(value) && isWholeNumber(reference)) {
+    auto difference = static_cast<juce::int64>(value) -
+                      static_cast<juce::int64>(reference);
+    writeVarint(out, zigzagEncode(difference) << 1);
+    return;
+  }
+
+  writeVarint(out, 1);
+  auto difference = toBits(value) ^ toBits(reference);
+  int leadingBytes = 0;
+  while (leadingBytes < 8 &&
+         ((difference >> (56 - 8 * leadingBytes)) & 0xff) == 0) {
+    leadingBytes++;
+  }
+  int trailingBytes = 0;
+  while (trailingBytes < 8 - leadingBytes &&
+         ((difference >> (8 * trailingBytes)) & 0xff) == 0) {
+    trailingBytes++;
+  }
+
+  out.writeByte(static_cast<char>((leadingBytes << 4) | trailingBytes));
+  for (int byte = 7 - leadingBytes; byte >= trailingBytes; byte--) {
+    out.writeByte(static_cast<char>((difference >> (8 * byte)) & 0xff));
+  }
+}
+
+bool readValue(const juce::uint8*& cursor, const juce::uint8* end,
+               double reference, double& value) {
+  juce::uint64 tag;
+  if (!readVarint(cursor, end, tag)) return false;
+  if ((tag & 1) == 0) {
+    if (!isWholeNumber(reference)) return false;
+    value = static_cast<double>(static_cast<juce::int64>(reference) +
+                                zigzagDecode(tag >> 1));
+    return true;
+  }
+
+  if (tag != 1 || cursor >= end) return false;
+  int leadingBytes = *cursor >> 4;
+  int trailingBytes = *cursor & 0x0f;
+  cursor++;
+  if (leadingBytes + trailingBytes > 8 ||
+      end - cursor < 8 - leadingBytes - trailingBytes) {
+    return false;
+  }
+
+  juce::uint64 difference = 0;
+  for (int byte = 7 - leadingBytes; byte >= trailingBytes; byte--) {
+    difference |= static_cast<juce::uint64>(*cursor++) << (8 * byte);
+  }
+  value = fromBits(toBits(reference) ^ difference);
+  return true;
+}
+
+/**
+ * Returns what a region's value for a day is stored relative to: its
+ * previous value, or else the value of the latest day before it
+ */
+double getReference(const std::map<int, double>& values, int day) {
+  auto next = values.lower_bound(day);
+  if (next != values.end() && next->first == day) return next->second;
+  return next == values.begin() ? 0.0 : std::prev(next)->second;
+}
+
+/** Where a region's first stored day in a record is counted from */
+juce::int64 getFirstDayBase(const std::map<int, double>& values) {
+  return values.empty() ? 0 : values.rbegin()->first + 1;
+}
+
+/** Writes days as runs of consecutive days */
+void writeDays(juce::MemoryOutputStream& out, const std::vector<int>& days) {
+  std::vector<std::pair<int, int>> runs;
+  for (int day : days) {
+    if (!runs.empty() && day == runs.back().first + runs.back().second) {
+      runs.back().second++;
+    } else {
+      runs.push_back({day, 1});
+    }
+  }
+
+  writeVarint(out, runs.size());
+  juce::int64 previousEnd = 0;
+  for (const auto& run : runs) {
+    writeVarint(out, zigzagEncode(run.first - previousEnd));
+    writeVarint(out, static_cast<juce::uint64>(run.second));
+    previousEnd = run.first + run.second;
+  }
+}
+
+bool readDays(const juce::uint8*& cursor, const juce::uint8* end,
+              std::vector<int>& days) {
+  juce::uint64 numRuns;
+  if (!readVarint(cursor, end, numRuns)) return false;
+
+  days.clear();
+  juce::int64 previousEnd = 0;
+  for (juce::uint64 i = 0; i < numRuns; i++) {
+    juce::uint64 start, length;
+    if (!readVarint(cursor, end, start) || !readVarint(cursor, end, length)) {
+      return false;
+    }
+    auto day = previousEnd + zigzagDecode(start);
+    // Days must stay ascending and fit in an int
+    if ((i > 0 && day <= previousEnd) ||
+        day + static_cast<juce::int64>(length) >
+            std::numeric_limits<int>::max() ||
+        day < std::numeric_limits<int>::min()) {
+      return false;
+    }
+    for (juce::uint64 j = 0; j < length; j++) {
+      days.push_back(static_cast<int>(day + static_cast<juce::int64>(j)));
+    }
+    previousEnd = day + static_cast<juce::int64>(length);
+  }
+  return true;
+}
+
+/** Gives repeated region names a count, so every column has its own key */
+std::vector<std::string> makeRegionKeys(
+    const std::vector<std::string>& regionNames) {
+  std::unordered_map<std::string, int> counts;
+  std::vector<std::string> keys;
+  for (const auto& name : regionNames) {
+    int count = counts[name]++;
+    keys.push_back(count == 0 ? name
+                              : name + '\0' + std::to_string(count));
+  }
+  return keys;
+}
+
+std::string getRegionName(const std::string& key) {
+  return key.substr(0, key.find('\0'));
+}
+}  // namespace
+
+SnapshotHistory::SnapshotHistory(const juce::File& historyDirectory)
+    : directory(historyDirectory) {
+  directory.createDirectory();
+
+  // Count the records that are whole, ignoring anything after the first
+  // one that isn't
+  juce::FileInputStream stream(getHistoryFile());
+  char magic[sizeof(kMagic)];
+  if (stream.failedToOpen() ||
+      stream.read(magic, sizeof(magic)) != sizeof(magic) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    return;
+  }
+
+  juce::MemoryBlock body;
+  endOfRecords = stream.getPosition();
+  while (readRecord(stream, body) && body.getSize() >= 8) {
+    fetchTimes.push_back(
+        juce::Time(juce::ByteOrder::littleEndianInt64(body.getData())));
+    endOfRecords = stream.getPosition();
+  }
+  numSnapshots = static_cast<int>(fetchTimes.size());
+}
+
+juce::Time SnapshotHistory::getSnapshotTime(int snapshot) const {
+  std::lock_guard<std::mutex> lock(fetchTimesLock);
+  if (snapshot < 0 || snapshot >= fetchTimes.size()) return {};
+  return fetchTimes[snapshot];
+}
+
+bool SnapshotHistory::addSnapshot(const DataTable& table,
+                                  juce::Time fetchTime) {
+  int snapshot = numSnapshots;
+  if (!hasLatestState) {
+    latestState = State();
+    hasLatestState = snapshot == 0 || replay(snapshot - 1, nullptr,
+                                             latestState);
+    if (!hasLatestState) return false;
+  }
+  auto& state = latestState;
+
+  // Give regions that haven't been seen before the next keys
+  auto keys = makeRegionKeys(table.getRegionNames());
+  std::unordered_map<std::string, int> keyIndices;
+  for (int i = 0; i < state.regionKeys.size(); i++) {
+    keyIndices[state.regionKeys[i]] = i;
+  }
+  std::vector<std::string> newKeys;
+  std::vector<int> regions;
+  for (const auto& key : keys) {
+    auto found = keyIndices.find(key);
+    if (found == keyIndices.end()) {
+      int index = static_cast<int>(state.regionKeys.size() + newKeys.size());
+      found = keyIndices.emplace(key, index).first;
+      newKeys.push_back(key);
+    }
+    regions.push_back(found->second);
+  }
+
+  // Encode only the values that differ from the latest ones stored, in
+  // order of key so that the record can store the gaps between them
+  state.values.resize(state.regionKeys.size() + newKeys.size());
+  std::vector<int> columnOrder(regions.size());
+  std::iota(columnOrder.begin(), columnOrder.end(), 0);
+  std::sort(columnOrder.begin(), columnOrder.end(),
+            [&](int a, int b) { return regions[a] < regions[b]; });
+
+  const auto& days = table.getDays();
+  juce::MemoryOutputStream blocks;
+  int numBlocks = 0;
+  int previousRegion = -1;
+  for (int column : columnOrder) {
+    auto& values = state.values[regions[column]];
+    const double* tableValues = table.getColumn(column);
+
+    juce::MemoryOutputStream block;
+    juce::int64 previousDay = getFirstDayBase(values) - 1;
+    for (int row = 0; row < table.getNumRows(); row++) {
+      auto existing = values.find(days[row]);
+      if (existing != values.end() &&
+          toBits(existing->second) == toBits(tableValues[row])) {
+        continue;
+      }
+
+      // The first day is relative to the region's last, so a new day
+      // costs a single byte
+      bool isFirst = block.getDataSize() == 0;
+      auto gap = days[row] - previousDay - 1;
+      writeVarint(block, isFirst ? zigzagEncode(gap)
+                                 : static_cast<juce::uint64>(gap));
+      writeValue(block, tableValues[row], getReference(values, days[row]));
+      values[days[row]] = tableValues[row];
+      previousDay = days[row];
+    }
+
+    if (block.getDataSize() > 0) {
+      writeVarint(blocks, regions[column] - previousRegion - 1);
+      writeVarint(blocks, block.getDataSize());
+      blocks << block.getMemoryBlock();
+      previousRegion = regions[column];
+      numBlocks++;
+    }
+  }
+
+  bool regionsChanged = regions != state.regions;
+  if (numBlocks == 0 && !regionsChanged && days == state.days) return false;
+
+  juce::MemoryOutputStream body;
+  body.writeInt64(fetchTime.toMilliseconds());
+  writeVarint(body, newKeys.size());
+  for (const auto& key : newKeys) {
+    writeVarint(body, key.size());
+    body.write(key.data(), key.size());
+  }
+
+  // Regions are written as gaps between keys, or as 0 if they're unchanged
+  writeVarint(body, regionsChanged ? regions.size() + 1 : 0);
+  if (regionsChanged) {
+    int previous = -1;
+    for (int region : regions) {
+      writeVarint(body, zigzagEncode(region - previous));
+      previous = region;
+    }
+  }
+
+  writeDays(body, days);
+  writeVarint(body, static_cast<juce::uint64>(numBlocks));
+  body << blocks.getMemoryBlock();
+
+  bool wasWritten = false;
+  {
+    juce::FileOutputStream out(getHistoryFile());
+    // Overwrite anything left after the last whole record
+    if (!out.failedToOpen() && out.setPosition(endOfRecords) &&
+        out.truncate().wasOk()) {
+      if (endOfRecords == 0) out.write(kMagic, sizeof(kMagic));
+      out.writeInt(static_cast<int>(body.getDataSize()));
+      out.writeInt(
+          static_cast<int>(hashBytes(body.getData(), body.getDataSize())));
+      out << body.getMemoryBlock();
+      out.flush();
+      wasWritten = out.getStatus().wasOk();
+      if (wasWritten) endOfRecords = out.getPosition();
+    }
+  }
+
+  if (!wasWritten) {
+    // The state already holds this snapshot's values, so rebuild it from
+    // the file next time
+    hasLatestState = false;
+    return false;
+  }
+
+  state.regionKeys.insert(state.regionKeys.end(), newKeys.begin(),
+                          newKeys.end());
+  state.regions = std::move(regions);
+  state.days = days;
+  {
+    std::lock_guard<std::mutex> lock(fetchTimesLock);
+    fetchTimes.push_back(fetchTime);
+  }
+  numSnapshots = snapshot + 1;
+  return true;
+}
+
+bool SnapshotHistory::readSnapshot(int snapshot, DataTable& table) const {
+  State state;
+  if (!replay(snapshot, nullptr, state)) return false;
+
+  std::vector<std::string> regionNames;
+  std::vector<double> values;
+  values.reserve(state.days.size() * state.regions.size());
+  for (int region : state.regions) {
+    regionNames.push_back(getRegionName(state.regionKeys[region]));
+    const auto& regionValues = state.values[region];
+    for (int day : state.days) {
+      auto value = regionValues.find(day);
+      if (value == regionValues.end()) return false;
+      values.push_back(value->second);
+    }
+  }
+
+  table.setData(std::move(regionNames), std::move(state.days),
+                std::move(values));
+  return true;
+}
+
+bool SnapshotHistory::readColumn(int snapshot, const std::string& regionName,
+                                 std::vector<int>& days,
+                                 std::vector<double>& values) const {
+  State state;
+  if (!replay(snapshot, &regionName, state)) return false;
+
+  for (int region : state.regions) {
+    if (state.regionKeys[region] != regionName) continue;
+
+    const auto& regionValues = state.values[region];
+    values.clear();
+    for (int day : state.days) {
+      auto value = regionValues.find(day);
+      if (value == regionValues.end()) return false;
+      values.push_back(value->second);
+    }
+    days = std::move(state.days);
+    return true;
+  }
+  return false;
+}
+
+juce::File SnapshotHistory::getHistoryFile() const {
+  return directory.getChildFile("history.dsh");
+}
+
+juce::File SnapshotHistory::getDefaultDirectory() {
+  return juce::File::getSpecialLocation(
+             juce::File::userApplicationDataDirectory)
+      .getChildFile("DataSonification")
+      .getChildFile("History");
+}
+
+bool SnapshotHistory::readRecord(juce::InputStream& stream,
+                                 juce::MemoryBlock& body) {
+  char header[kRecordHeaderSize];
+  if (stream.read(header, kRecordHeaderSize) != kRecordHeaderSize) {
+    return false;
+  }
+
+  auto size = juce::ByteOrder::littleEndianInt(header);
+  auto hash = juce::ByteOrder::littleEndianInt(header + 4);
+  if (size > static_cast<juce::uint64>(stream.getNumBytesRemaining())) {
+    return false;
+  }
+
+  body.setSize(size);
+  return stream.read(body.getData(), static_cast<int>(size)) ==
+             static_cast<int>(size) &&
+         hashBytes(body.getData(), body.getSize()) == hash;
+}
+
+bool SnapshotHistory::applyRecord(const juce::MemoryBlock& body,
+                                  const std::string* onlyRegion,
+                                  State& state) {
+  auto* cursor = static_cast<const juce::uint8*>(body.getData());
+  auto* end = cursor + body.getSize();
+  // Skip the fetch time, which was read when the history was opened
+  if (end - cursor < 8) return false;
+  cursor += 8;
+
+  juce::uint64 numNewKeys;
+  if (!readVarint(cursor, end, numNewKeys)) return false;
+  for (juce::uint64 i = 0; i < numNewKeys; i++) {
+    juce::uint64 length;
+    if (!readVarint(cursor, end, length) ||
+        length > static_cast<juce::uint64>(end - cursor)) {
+      return false;
+    }
+    state.regionKeys.emplace_back(reinterpret_cast<const char*>(cursor),
+                                  static_cast<size_t>(length));
+    cursor += length;
+  }
+  auto numKeys = static_cast<juce::int64>(state.regionKeys.size());
+  state.values.resize(state.regionKeys.size());
+
+  juce::uint64 numRegions;
+  if (!readVarint(cursor, end, numRegions)) return false;
+  if (numRegions > 0) {
+    state.regions.clear();
+    juce::int64 region = -1;
+    for (juce::uint64 i = 0; i + 1 < numRegions; i++) {
+      juce::uint64 gap;
+      if (!readVarint(cursor, end, gap)) return false;
+      region += zigzagDecode(gap);
+      if (region < 0 || region >= numKeys) return false;
+      state.regions.push_back(static_cast<int>(region));
+    }
+  }
+
+  if (!readDays(cursor, end, state.days)) return false;
+
+  juce::uint64 numBlocks;
+  if (!readVarint(cursor, end, numBlocks)) return false;
+  juce::int64 region = -1;
+  for (juce::uint64 i = 0; i < numBlocks; i++) {
+    juce::uint64 gap, size;
+    if (!readVarint(cursor, end, gap) || !readVarint(cursor, end, size) ||
+        size > static_cast<juce::uint64>(end - cursor)) {
+      return false;
+    }
+    region += static_cast<juce::int64>(gap) + 1;
+    if (region >= numKeys) return false;
+
+    const juce::uint8* blockEnd = cursor + size;
+    if (onlyRegion != nullptr && state.regionKeys[region] != *onlyRegion) {
+      cursor = blockEnd;
+      continue;
+    }
+
+    auto& values = state.values[region];
+    juce::int64 previousDay = getFirstDayBase(values) - 1;
+    bool isFirst = true;
+    while (cursor < blockEnd) {
+      juce::uint64 dayGap;
+      if (!readVarint(cursor, blockEnd, dayGap)) return false;
+      auto day = previousDay + 1 +
+                 (isFirst ? zigzagDecode(dayGap)
+                          : static_cast<juce::int64>(dayGap));
+      if (day < std::numeric_limits<int>::min() ||
+          day > std::numeric_limits<int>::max()) {
+        return false;
+      }
+
+      double value;
+      auto reference = getReference(values, static_cast<int>(day));
+      if (!readValue(cursor, blockEnd, reference, value)) return false;
+      values[static_cast<int>(day)] = value;
+      previousDay = day;
+      isFirst = false;
+    }
+  }
+  return cursor == end;
+}
+
+bool SnapshotHistory::replay(int snapshot, const std::string* onlyRegion,
+                             State& state) const {
+  if (snapshot < 0 || snapshot >= numSnapshots) return false;
+
+  juce::FileInputStream stream(getHistoryFile());
+  char magic[sizeof(kMagic)];
+  if (stream.failedToOpen() ||
+      stream.read(magic, sizeof(magic)) != sizeof(magic) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    return false;
+  }
+
+  juce::MemoryBlock body;
+  for (int i = 0; i <= snapshot; i++) {
+    if (!readRecord(stream, body) || !applyRecord(body, onlyRegion, state)) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+#include "DataTable.h"
+
+//==============================================================================
+/*
+    Keeps every downloaded version of the dataset on disk so that earlier
+    versions can be replayed after OWID revises past values.
+
+    All versions share one append-only file, which holds a revision log for
+    each region: a value is stored once, by the first snapshot it appears in,
+    and again only by a snapshot that revises it. Each snapshot appends one
+    record with its fetch time, its dates as runs of consecutive days, its
+    regions (only when they change), and the new or revised values of each
+    region. Whole numbers are stored as a zigzag varint of their difference
+    from the value they replace, or from the day before if they're new. Other
+    values store the bytes that differ from it.
+
+    Storage therefore only grows with new days and revisions. Reading any
+    snapshot, or one region of it, is a single forward pass over the records
+    up to it, decoding only that region's values.
+*/
+class SnapshotHistory {
+ public:
+  explicit SnapshotHistory(const juce::File& directory);
+
+  /** Safe to call from any thread while a snapshot is being added */
+  int getNumSnapshots() const noexcept { return numSnapshots; }
+
+  /** Returns when a snapshot was fetched */
+  juce::Time getSnapshotTime(int snapshot) const;
+
+  /**
+   * Stores a new snapshot after the existing ones. Returns false if it
+   * couldn't be written, or if it is identical to the latest snapshot (in
+   * which case nothing is stored).
+   */
+  bool addSnapshot(const DataTable& table, juce::Time fetchTime);
+
+  /** Decodes a whole snapshot. Returns false if it couldn't be read. */
+  bool readSnapshot(int snapshot, DataTable& table) const;
+
+  /**
+   * Decodes one region of a snapshot. Returns false if it couldn't be read or
+   * didn't contain the region.
+   */
+  bool readColumn(int snapshot, const std::string& regionName,
+                  std::vector<int>& days, std::vector<double>& values) const;
+
+  /** Returns the file that every snapshot is stored in */
+  juce::File getHistoryFile() const;
+
+  /** Returns the default location, inside the user's app data folder */
+  static juce::File getDefaultDirectory();
+
+ private:
+  /** What a snapshot's record is decoded against, once it's been applied */
+  struct State {
+    /** Region names, made unique by appending a count to repeated ones */
+    std::vector<std::string> regionKeys;
+    /** The latest snapshot's regions, as indices into regionKeys */
+    std::vector<int> regions;
+    std::vector<int> days;
+    /** The latest value of every day ever stored, for each region key */
+    std::vector<std::map<int, double>> values;
+  };
+
+  /** Reads the next record's body, checking it against its hash */
+  static bool readRecord(juce::InputStream& stream, juce::MemoryBlock& body);
+  /**
+   * Applies a record to the state. If onlyRegion isn't null, the values of
+   * every other region are skipped.
+   */
+  static bool applyRecord(const juce::MemoryBlock& body,
+                          const std::string* onlyRegion, State& state);
+  /** Applies the records of every snapshot up to and including this one */
+  bool replay(int snapshot, const std::string* onlyRegion,
+              State& state) const;
+
+  juce::File directory;
+  /** Written on the loader thread and read on the message thread */
+  std::atomic<int> numSnapshots{0};
+  std::vector<juce::Time> fetchTimes;
+  mutable std::mutex fetchTimesLock;
+
+  /** Where the next record goes, past any partly written one */
+  juce::int64 endOfRecords = 0;
+  /** The state after the latest snapshot, which the next one is encoded
+      against */
+  State latestState;
+  bool hasLatestState = false;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SnapshotHistory)
+};
@@ -0,0 +1,277 @@
+#include <JuceHeader.h>
+
+#include "SnapshotHistory.h"
+
+//==============================================================================
+/*
+    Stores series of tables with SnapshotHistory and checks that every one of
+    them reads back exactly, that damaged files are refused, and that a year of
+    daily snapshots takes no more space than its final CSV.
+*/
+class SnapshotHistoryTests : public juce::UnitTest {
+ public:
+  SnapshotHistoryTests()
+      : juce::UnitTest("SnapshotHistory", "DataSonification") {}
+
+  void runTest() override {
+    auto directory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                         .getChildFile("SnapshotHistoryTests");
+
+    beginTest("Snapshots read back exactly as they were added");
+    {
+      directory.deleteRecursively();
+      auto tables = makeRevisedTables();
+      SnapshotHistory history(directory);
+      for (int i = 0; i < tables.size(); i++) {
+        expect(history.addSnapshot(tables[i], juce::Time(1000 * (i + 1))));
+      }
+      expectEquals(history.getNumSnapshots(), (int)tables.size());
+      expectReadsBack(history, tables);
+
+      // Opening the file again replays it before adding the next snapshot
+      SnapshotHistory reopened(directory);
+      expectEquals(reopened.getNumSnapshots(), (int)tables.size());
+      expect(reopened.getSnapshotTime(3) == juce::Time(4000));
+      tables.push_back(makeTable({"A", "C"}, {100, 101, 102}, 7.0));
+      expect(reopened.addSnapshot(tables.back(), juce::Time(0)));
+      expectReadsBack(reopened, tables);
+    }
+
+    beginTest("Re-fetching the latest snapshot stores nothing");
+    {
+      directory.deleteRecursively();
+      auto table = makeTable({"A", "B"}, {10, 11, 12}, 1.0);
+      SnapshotHistory history(directory);
+      expect(history.addSnapshot(table, juce::Time(1)));
+      auto size = history.getHistoryFile().getSize();
+      expect(!history.addSnapshot(table, juce::Time(2)));
+      expectEquals(history.getNumSnapshots(), 1);
+      expectEquals(history.getHistoryFile().getSize(), size);
+
+      SnapshotHistory reopened(directory);
+      expect(!reopened.addSnapshot(table, juce::Time(3)));
+      expectEquals(reopened.getNumSnapshots(), 1);
+    }
+
+    beginTest("A partly written record is ignored and then overwritten");
+    {
+      directory.deleteRecursively();
+      auto tables = makeRevisedTables();
+      {
+        SnapshotHistory history(directory);
+        for (const auto& table : tables) history.addSnapshot(table, {});
+      }
+      auto file = directory.getChildFile("history.dsh");
+      juce::MemoryBlock data;
+      file.loadFileAsData(data);
+      file.replaceWithData(data.getData(), data.getSize() - 3);
+
+      SnapshotHistory history(directory);
+      expectEquals(history.getNumSnapshots(), (int)tables.size() - 1);
+      DataTable table;
+      expect(!history.readSnapshot((int)tables.size() - 1, table));
+      expect(history.addSnapshot(tables.back(), {}));
+      expectReadsBack(history, tables);
+    }
+
+    beginTest("Damaged files are refused");
+    {
+      directory.deleteRecursively();
+      auto tables = makeRevisedTables();
+      SnapshotHistory history(directory);
+      for (const auto& table : tables) history.addSnapshot(table, {});
+
+      auto file = history.getHistoryFile();
+      juce::MemoryBlock data;
+      file.loadFileAsData(data);
+      auto* bytes = static_cast<char*>(data.getData());
+
+      // Damage a byte in the middle of the history
+      bytes[data.getSize() / 2] ^= 0x10;
+      file.replaceWithData(data.getData(), data.getSize());
+      DataTable table;
+      std::vector<int> days;
+      std::vector<double> values;
+      expect(!history.readSnapshot((int)tables.size() - 1, table));
+      expect(!history.readColumn((int)tables.size() - 1, "A", days, values));
+      expect(SnapshotHistory(directory).getNumSnapshots() <
+             (int)tables.size());
+
+      // Damage the magic
+      bytes[data.getSize() / 2] ^= 0x10;
+      bytes[0] = 'X';
+      file.replaceWithData(data.getData(), data.getSize());
+      expect(!history.readSnapshot(0, table));
+      expectEquals(SnapshotHistory(directory).getNumSnapshots(), 0);
+
+      // Cut the file short
+      file.replaceWithData(data.getData(), 2);
+      expect(!history.readSnapshot(0, table));
+      expect(!history.readSnapshot(-1, table));
+      expect(!history.readSnapshot((int)tables.size(), table));
+    }
+
+    beginTest("A year of daily snapshots is smaller than its CSV");
+    {
+      directory.deleteRecursively();
+      SnapshotHistory history(directory);
+      juce::Random random(0x030);
+      std::vector<std::string> names;
+      for (int i = 0; i < kNumRegions; i++) {
+        names.push_back("Region " + std::to_string(i));
+      }
+
+      // Cumulative counts, with a few recent days revised by every fetch
+      std::vector<std::vector<double>> counts(kNumRegions);
+      for (auto& regionCounts : counts) {
+        double count = 0.0;
+        for (int day = 0; day < kFirstNumDays + kNumFetches; day++) {
+          count += random.nextInt(200);
+          regionCounts.push_back(count);
+        }
+      }
+
+      DataTable table;
+      for (int fetch = 0; fetch < kNumFetches; fetch++) {
+        int numDays = kFirstNumDays + fetch;
+        for (int i = 0; i < kRevisionsPerFetch; i++) {
+          counts[random.nextInt(kNumRegions)]
+                [numDays - 1 - random.nextInt(14)] += random.nextInt(20);
+        }
+        table = makeTable(names, counts, numDays);
+        expect(history.addSnapshot(table, juce::Time(fetch)));
+      }
+
+      auto csvSize = getCsvSize(table);
+      auto storedSize = history.getHistoryFile().getSize();
+      logMessage("Stored " + juce::String(storedSize) + " bytes for a " +
+                 juce::String(csvSize) + " byte CSV");
+      expectLessThan((double)storedSize, kMaxStorageRatio * csvSize);
+
+      DataTable latest;
+      expect(history.readSnapshot(kNumFetches - 1, latest));
+      expect(latest == table);
+    }
+
+    directory.deleteRecursively();
+  }
+
+ private:
+  static constexpr int kNumRegions = 100;
+  static constexpr int kFirstNumDays = 600;
+  static constexpr int kNumFetches = 365;
+  static constexpr int kRevisionsPerFetch = 3;
+  static constexpr double kMaxStorageRatio = 1.0;
+
+  static DataTable makeTable(std::vector<std::string> names,
+                             std::vector<int> days, double firstValue) {
+    std::vector<double> values;
+    for (size_t region = 0; region < names.size(); region++) {
+      for (size_t row = 0; row < days.size(); row++) {
+        values.push_back(firstValue + region * 10.0 + row);
+      }
+    }
+    DataTable table;
+    table.setData(std::move(names), std::move(days), std::move(values));
+    return table;
+  }
+
+  static DataTable makeTable(const std::vector<std::string>& names,
+                             const std::vector<std::vector<double>>& counts,
+                             int numDays) {
+    std::vector<int> days(numDays);
+    std::iota(days.begin(), days.end(), 18000);
+    std::vector<double> values;
+    for (const auto& regionCounts : counts) {
+      values.insert(values.end(), regionCounts.begin(),
+                    regionCounts.begin() + numDays);
+    }
+    DataTable table;
+    table.setData(names, std::move(days), std::move(values));
+    return table;
+  }
+
+  /**
+   * Tables that add and remove regions and days, repeat a region name, and
+   * revise values, including to fractions and -0
+   */
+  static std::vector<DataTable> makeRevisedTables() {
+    std::vector<DataTable> tables;
+    std::vector<int> days{100, 101, 102};
+    for (int i = 0; i < 40; i++) {
+      std::vector<std::string> names{"A", "B"};
+      if (i >= 5 && i < 12) names.push_back("C");
+      if (i >= 20) names.insert(names.begin(), "D");
+      if (i == 30) names.push_back("A");
+
+      if (i % 3 == 0) days.push_back(days.back() + 1);
+      // Drop a day, skip a few, then bring the dropped one back
+      if (i == 8) days.erase(days.begin() + 1);
+      if (i == 9) days.push_back(days.back() + 5);
+      if (i == 15) days.insert(days.begin() + 1, 101);
+
+      auto table = makeTable(names, days, 1.0);
+      auto numValues = table.getNumRows() * table.getNumRegions();
+      std::vector<double> values(table.getColumn(0),
+                                 table.getColumn(0) + numValues);
+      values[i % values.size()] += 0.1 * i;
+      if (i == 25) values[1] = -0.0;
+      if (i == 26) values.back() = 1.0e300;
+      table.setData(names, days, std::move(values));
+      tables.push_back(std::move(table));
+    }
+    return tables;
+  }
+
+  /** Compares bit for bit, so that -0 isn't taken for +0 */
+  static bool isIdentical(const std::vector<double>& a, const double* b) {
+    return std::memcmp(a.data(), b, a.size() * sizeof(double)) == 0;
+  }
+
+  void expectReadsBack(const SnapshotHistory& history,
+                       const std::vector<DataTable>& tables) {
+    for (int i = 0; i < tables.size(); i++) {
+      const auto& expected = tables[i];
+      DataTable table;
+      expect(history.readSnapshot(i, table), "Snapshot " + juce::String(i));
+      expect(table == expected, "Snapshot " + juce::String(i));
+
+      // A repeated name reads back its first column
+      for (int region = expected.getNumRegions() - 1; region >= 0; region--) {
+        std::vector<int> days;
+        std::vector<double> values;
+        const auto& name = expected.getRegionNames()[region];
+        expect(history.readColumn(i, name, days, values));
+        auto first = std::find(expected.getRegionNames().begin(),
+                               expected.getRegionNames().end(), name);
+        auto column = expected.getColumn(
+            (int)(first - expected.getRegionNames().begin()));
+        expect(days == expected.getDays() &&
+                   values.size() == expected.getNumRows() &&
+                   isIdentical(values, column),
+               "Snapshot " + juce::String(i) + ", region " + name);
+      }
+
+      std::vector<int> days;
+      std::vector<double> values;
+      expect(!history.readColumn(i, "Nowhere", days, values));
+    }
+  }
+
+  /** The size of the table as OWID's CSV, with a header and a date per row */
+  static juce::int64 getCsvSize(const DataTable& table) {
+    juce::int64 size = 4;
+    for (const auto& name : table.getRegionNames()) size += 1 + name.size();
+    size += 1;
+    for (int row = 0; row < table.getNumRows(); row++) {
+      size += 10 + 1;
+      for (int region = 0; region < table.getNumRegions(); region++) {
+        size += 1 + juce::String((juce::int64)table.getColumn(region)[row])
+                        .length();
+      }
+    }
+    return size;
+  }
+};
+
+static SnapshotHistoryTests snapshotHistoryTests;
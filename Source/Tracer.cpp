@@ -0,0 +1,105 @@
+#include "Tracer.h"
+
+#if DATA_SONIFICATION_TRACING
+
+Tracer::ThreadBuffer Tracer::buffers[Tracer::kMaxThreads];
+std::atomic<int> Tracer::numClaimedBuffers{0};
+
+Tracer::ThreadBuffer* Tracer::getThreadBuffer(const char* name) noexcept {
+  // Plain pointer, so taking a thread-local never allocates
+  static thread_local ThreadBuffer* threadBuffer = nullptr;
+  // Set even if no buffer was left, so that a thread without one doesn't bump
+  // the counter again on every span
+  static thread_local bool hasClaimedBuffer = false;
+
+  if (!hasClaimedBuffer) {
+    hasClaimedBuffer = true;
+    if (name != nullptr) threadBuffer = findNamedBuffer(name);
+    if (threadBuffer == nullptr) {
+      int index = numClaimedBuffers.fetch_add(1);
+      if (index < kMaxThreads) threadBuffer = &buffers[index];
+    }
+  }
+  return threadBuffer;
+}
+
+Tracer::ThreadBuffer* Tracer::findNamedBuffer(const char* name) noexcept {
+  int numThreads = juce::jmin(numClaimedBuffers.load(), kMaxThreads);
+  for (int thread = 0; thread < numThreads; thread++) {
+    auto* threadName = buffers[thread].threadName.load();
+    if (threadName != nullptr && std::strcmp(threadName, name) == 0) {
+      return &buffers[thread];
+    }
+  }
+  return nullptr;
+}
+
+void Tracer::setCurrentThreadName(const char* name) noexcept {
+  if (auto* buffer = getThreadBuffer(name)) {
+    buffer->threadName.store(name, std::memory_order_relaxed);
+  }
+}
+
+void Tracer::record(const char* name, juce::int64 startTicks,
+                    juce::int64 endTicks) noexcept {
+  auto* buffer = getThreadBuffer();
+  if (buffer == nullptr) return;
+
+  auto index = buffer->numWritten.load(std::memory_order_relaxed);
+  buffer->events[index % kEventsPerThread] = {name, startTicks, endTicks};
+  buffer->numWritten.store(index + 1, std::memory_order_release);
+}
+
+bool Tracer::writeChromeTrace(const juce::File& file) {
+  file.deleteFile();
+  juce::FileOutputStream stream(file);
+  if (stream.failedToOpen()) return false;
+
+  auto ticksToMicroseconds = [](juce::int64 ticks) {
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+  };
+
+  stream << "{\"traceEvents\":[";
+  bool isFirstEvent = true;
+  auto writeSeparator = [&] {
+    if (!isFirstEvent) stream << ",";
+    stream << "\n";
+    isFirstEvent = false;
+  };
+
+  int numThreads = juce::jmin(numClaimedBuffers.load(), kMaxThreads);
+  for (int thread = 0; thread < numThreads; thread++) {
+    auto& buffer = buffers[thread];
+
+    if (auto* threadName = buffer.threadName.load(std::memory_order_relaxed)) {
+      writeSeparator();
+      stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << thread << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+    }
+
+    auto numWritten = buffer.numWritten.load(std::memory_order_acquire);
+    auto firstIndex =
+        numWritten > (juce::uint32)kEventsPerThread
+            ? numWritten - (juce::uint32)kEventsPerThread
+            : 0u;
+
+    for (auto i = firstIndex; i < numWritten; i++) {
+      const auto& event = buffer.events[i % kEventsPerThread];
+      writeSeparator();
+      stream << "{\"name\":\"" << event.name
+             << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+             << ",\"ts\":"
+             << juce::String(ticksToMicroseconds(event.startTicks), 3)
+             << ",\"dur\":"
+             << juce::String(
+                    ticksToMicroseconds(event.endTicks - event.startTicks), 3)
+             << "}";
+    }
+  }
+
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  stream.flush();
+  return stream.getStatus().wasOk();
+}
+
+#endif
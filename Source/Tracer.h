@@ -0,0 +1,104 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Set this to 1 to record trace spans (e.g. in the Projucer preprocessor
+    definitions). When 0, every TRACE_ macro compiles to nothing. */
+#ifndef DATA_SONIFICATION_TRACING
+#define DATA_SONIFICATION_TRACING 0
+#endif
+
+#if DATA_SONIFICATION_TRACING
+
+#include <atomic>
+
+//==============================================================================
+/*
+    Records timed spans into per-thread ring buffers and writes them out as
+    Chrome trace JSON (viewable in chrome://tracing or ui.perfetto.dev).
+
+    All buffers are statically allocated and each is only written by one
+    thread at a time, so recording a span never locks or allocates and is safe
+    on the audio thread. A thread that is replaced by a new one with the same
+    name, like the audio thread after a device restart, hands its buffer on.
+*/
+class Tracer {
+ public:
+  static constexpr int kMaxThreads = 16;
+  static constexpr int kEventsPerThread = 1 << 14;
+
+  /**
+   * Names the calling thread in the trace, claiming a buffer for it if it
+   * doesn't have one yet. If a previous thread already used the name, its
+   * buffer is reused, so the two must never run at the same time. Call this
+   * before the thread records any spans. The name must be a string literal.
+   */
+  static void setCurrentThreadName(const char* name) noexcept;
+
+  /**
+   * Records a completed span on the calling thread. Once a thread's buffer is
+   * full, its oldest spans are overwritten.
+   */
+  static void record(const char* name, juce::int64 startTicks,
+                     juce::int64 endTicks) noexcept;
+
+  /**
+   * Writes every thread's recorded spans to a Chrome trace JSON file. Spans
+   * that are being overwritten while this runs may come out garbled, which is
+   * an acceptable trade for never blocking the recording threads.
+   */
+  static bool writeChromeTrace(const juce::File& file);
+
+ private:
+  struct Event {
+    const char* name;
+    juce::int64 startTicks;
+    juce::int64 endTicks;
+  };
+
+  struct ThreadBuffer {
+    std::atomic<const char*> threadName;
+    std::atomic<juce::uint32> numWritten;
+    Event events[kEventsPerThread];
+  };
+
+  /**
+   * Returns the calling thread's buffer, claiming one the first time it's
+   * called, preferring the buffer of an earlier thread with the given name.
+   * Returns nullptr if every buffer was already claimed by then.
+   */
+  static ThreadBuffer* getThreadBuffer(const char* name = nullptr) noexcept;
+  static ThreadBuffer* findNamedBuffer(const char* name) noexcept;
+
+  static ThreadBuffer buffers[kMaxThreads];
+  static std::atomic<int> numClaimedBuffers;
+};
+
+//==============================================================================
+/* Records the lifetime of a scope as a single span */
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(const char* spanName) noexcept
+      : name(spanName), startTicks(juce::Time::getHighResolutionTicks()) {}
+
+  ~ScopedTrace() noexcept {
+    Tracer::record(name, startTicks, juce::Time::getHighResolutionTicks());
+  }
+
+ private:
+  const char* name;
+  juce::int64 startTicks;
+
+  JUCE_DECLARE_NON_COPYABLE(ScopedTrace)
+};
+
+#define TRACE_SCOPE(name) \
+  ScopedTrace JUCE_JOIN_MACRO(scopedTrace_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) Tracer::setCurrentThreadName(name)
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_THREAD_NAME(name)
+
+#endif
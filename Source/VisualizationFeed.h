@@ -0,0 +1,74 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Carries output samples and the playback position from the audio thread to
+    the GUI. Samples go through a single-producer, single-consumer ring
+    buffer, so publishing a block is two memcpys at most and never waits on
+    the GUI. If the GUI falls behind, the newest samples are dropped instead.
+*/
+class VisualizationFeed {
+ public:
+  static constexpr int kCapacity = 1 << 15;
+
+  VisualizationFeed() : samples(kCapacity) {}
+
+  /** Audio thread only */
+  void pushSamples(const float* source, int numSamples) noexcept {
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    if (size1 > 0) {
+      std::memcpy(samples.data() + start1, source, size1 * sizeof(float));
+    }
+    if (size2 > 0) {
+      std::memcpy(samples.data() + start2, source + size1,
+                  size2 * sizeof(float));
+    }
+    fifo.finishedWrite(size1 + size2);
+  }
+
+  /** GUI thread only. Returns the number of samples copied. */
+  int popSamples(float* destination, int maxSamples) noexcept {
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+    if (size1 > 0) {
+      std::memcpy(destination, samples.data() + start1, size1 * sizeof(float));
+    }
+    if (size2 > 0) {
+      std::memcpy(destination + size1, samples.data() + start2,
+                  size2 * sizeof(float));
+    }
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+  }
+
+  void setNoteIndex(int index) noexcept {
+    noteIndex.store(index, std::memory_order_relaxed);
+  }
+  int getNoteIndex() const noexcept {
+    return noteIndex.load(std::memory_order_relaxed);
+  }
+
+  void setSampleRate(double rate) noexcept {
+    sampleRate.store(rate, std::memory_order_relaxed);
+  }
+  double getSampleRate() const noexcept {
+    return sampleRate.load(std::memory_order_relaxed);
+  }
+
+  /** Only safe while the audio thread isn't pushing, e.g. before playback */
+  void reset() noexcept {
+    fifo.reset();
+    noteIndex.store(0);
+  }
+
+ private:
+  juce::AbstractFifo fifo{kCapacity};
+  std::vector<float> samples;
+  std::atomic<int> noteIndex{0};
+  std::atomic<double> sampleRate{44100.0};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VisualizationFeed)
+};
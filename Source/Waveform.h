@@ -0,0 +1,6 @@
+#pragma once
+
+//==============================================================================
+/* The oscillator shapes shared by the note, continuous and deterministic
+   renderers */
+enum class Waveform { kSine, kSquare, kTriangle, kSaw };
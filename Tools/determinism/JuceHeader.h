@@ -0,0 +1,113 @@
+/*
+    Just enough of JUCE to build DeterministicRenderer, Scale and their unit
+    tests without the framework, so that check.sh can compile them with any
+    compiler flags. Only what those files use is here.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace juce {
+typedef std::int32_t int32;
+typedef std::uint32_t uint32;
+typedef std::int64_t int64;
+typedef std::uint64_t uint64;
+
+template <typename Type>
+Type jmin(Type a, Type b) {
+  return b < a ? b : a;
+}
+
+template <typename Type>
+Type jmax(Type a, Type b) {
+  return a < b ? b : a;
+}
+
+template <typename Type>
+Type jlimit(Type lowerLimit, Type upperLimit, Type value) {
+  return value < lowerLimit ? lowerLimit
+                            : (upperLimit < value ? upperLimit : value);
+}
+
+template <typename ElementType>
+using Array = std::vector<ElementType>;
+
+struct FloatVectorOperations {
+  static void clear(float* dest, int numValues) {
+    std::fill(dest, dest + numValues, 0.0f);
+  }
+};
+
+class String {
+ public:
+  String() = default;
+  String(const char* text) : text(text) {}
+  String(std::string text) : text(std::move(text)) {}
+  explicit String(int number) : text(std::to_string(number)) {}
+
+  static String toHexString(int64 number) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%llx",
+                  static_cast<unsigned long long>(number));
+    return String(hex);
+  }
+
+  const char* toRawUTF8() const { return text.c_str(); }
+  bool operator==(const String& other) const { return text == other.text; }
+  String operator+(const String& other) const { return text + other.text; }
+  friend String operator+(const char* a, const String& b) {
+    return std::string(a) + b.text;
+  }
+
+ private:
+  std::string text;
+};
+
+/** Collects failures the same way as juce::UnitTest, minus the runner */
+class UnitTest {
+ public:
+  UnitTest(const String& testName, const String& testCategory)
+      : name(testName), category(testCategory) {
+    getAllTests().push_back(this);
+  }
+  virtual ~UnitTest() = default;
+
+  virtual void runTest() = 0;
+
+  static std::vector<UnitTest*>& getAllTests() {
+    static std::vector<UnitTest*> tests;
+    return tests;
+  }
+
+  const String& getName() const { return name; }
+  int getNumFailures() const { return numFailures; }
+
+  void beginTest(const String& testName) {
+    std::printf("%s / %s\n", name.toRawUTF8(), testName.toRawUTF8());
+  }
+
+  void expect(bool result, const String& failureMessage = String()) {
+    if (!result) {
+      numFailures++;
+      std::printf("  FAILED: %s\n", failureMessage.toRawUTF8());
+    }
+  }
+
+  void expectEquals(const String& actual, const String& expected,
+                    const String& failureMessage = String()) {
+    expect(actual == expected, failureMessage + " -- expected " + expected +
+                                   ", got " + actual);
+  }
+
+ private:
+  String name, category;
+  int numFailures = 0;
+};
+}  // namespace juce
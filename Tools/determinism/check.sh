@@ -0,0 +1,26 @@
+#!/bin/sh
+# Builds the deterministic renderer's unit tests without JUCE at -O0, at
+# -O3 -ffast-math, and with -march=native added (which lets the compiler
+# contract into FMA instructions), and runs each. The tests pin every render's
+# hash, so all of them passing means every build renders identical samples.
+#
+# Usage: Tools/determinism/check.sh [compiler]
+
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+source_dir="$here/../../Source"
+build_dir=$(mktemp -d)
+trap 'rm -rf "$build_dir"' EXIT
+
+compiler=${1:-c++}
+sources="$here/run_tests.cpp $source_dir/DeterministicRenderer.cpp \
+  $source_dir/Scale.cpp $source_dir/DeterministicRendererTests.cpp"
+
+for flags in "-O0" "-O3 -ffast-math" "-O3 -ffast-math -march=native"; do
+  echo "== $compiler $flags"
+  # shellcheck disable=SC2086
+  "$compiler" -std=c++17 $flags -I"$here" -I"$source_dir" $sources \
+    -o "$build_dir/run_tests"
+  "$build_dir/run_tests"
+done
@@ -0,0 +1,13 @@
+#include <JuceHeader.h>
+
+/** Runs every test linked in, and returns 1 if any of them failed */
+int main() {
+  int numFailures = 0;
+  for (auto* test : juce::UnitTest::getAllTests()) {
+    test->runTest();
+    numFailures += test->getNumFailures();
+  }
+
+  std::printf("%d failure(s)\n", numFailures);
+  return numFailures > 0 ? 1 : 0;
+}